@@ -0,0 +1,377 @@
+#include "ai.h"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+constexpr size_t FRAME_GRANULE = 64;
+constexpr size_t FRAME_CLASSES = 16;
+constexpr size_t FRAME_CACHE_LIMIT = 1 << 14;
+constexpr int PATROL_LEG_TICKS = 40;
+
+struct FrameCache {
+    std::vector<void*> free[FRAME_CLASSES];
+
+    ~FrameCache() {
+        for (auto& list : free) {
+            for (void* p : list) ::operator delete(p);
+        }
+    }
+};
+
+thread_local FrameCache frame_cache;
+
+size_t frameClass(size_t size) {
+    return (size + FRAME_GRANULE - 1) / FRAME_GRANULE;
+}
+
+int sign(int v) {
+    return (v > 0) - (v < 0);
+}
+
+}
+
+void* FramePool::allocate(size_t size) {
+    size_t cls = frameClass(size);
+    if (cls == 0 || cls > FRAME_CLASSES) return ::operator new(size);
+
+    auto& list = frame_cache.free[cls - 1];
+    if (!list.empty()) {
+        void* p = list.back();
+        list.pop_back();
+        return p;
+    }
+    return ::operator new(cls * FRAME_GRANULE);
+}
+
+void FramePool::deallocate(void* p, size_t size) {
+    size_t cls = frameClass(size);
+    if (cls == 0 || cls > FRAME_CLASSES) {
+        ::operator delete(p);
+        return;
+    }
+
+    auto& list = frame_cache.free[cls - 1];
+    if (list.size() < FRAME_CACHE_LIMIT) {
+        list.push_back(p);
+    } else {
+        ::operator delete(p);
+    }
+}
+
+Behaviour& Behaviour::operator=(Behaviour&& o) noexcept {
+    if (this != &o) {
+        if (h) h.destroy();
+        h = o.h;
+        o.h = nullptr;
+    }
+    return *this;
+}
+
+Behaviour::~Behaviour() {
+    if (h) h.destroy();
+}
+
+bool Behaviour::resume() {
+    if (!h || h.done()) return false;
+    h.resume();
+    return !h.done() && !h.promise().error;
+}
+
+WorldView::WorldView(int width, int height, int cell_size)
+    : w(width), h(height), cell(std::max(1, cell_size)),
+      cols(width / cell + 1), rows(height / cell + 1)
+{}
+
+void WorldView::rebuild(const std::vector<std::shared_ptr<NPC>>& npcs) {
+    cell_start.assign(static_cast<size_t>(cols) * rows + 1, 0);
+
+    auto cellIndex = [this](int x, int y) {
+        int cx = std::clamp(x / cell, 0, cols - 1);
+        int cy = std::clamp(y / cell, 0, rows - 1);
+        return static_cast<size_t>(cy) * cols + cx;
+    };
+
+    for (const auto& npc : npcs) {
+        ++cell_start[cellIndex(npc->getX(), npc->getY()) + 1];
+    }
+    for (size_t i = 1; i < cell_start.size(); ++i) {
+        cell_start[i] += cell_start[i - 1];
+    }
+
+    items.resize(npcs.size());
+    std::vector<uint32_t> cursor(cell_start.begin(), cell_start.end() - 1);
+    for (const auto& npc : npcs) {
+        int x = npc->getX();
+        int y = npc->getY();
+        items[cursor[cellIndex(x, y)]++] = {npc.get(), x, y, npc->getKind()};
+    }
+}
+
+const WorldView::Sighting* WorldView::nearest(int x, int y, int radius, Kind kind, const NPC* exclude) const {
+    const Sighting* best = nullptr;
+    long best_d2 = static_cast<long>(radius) * radius;
+
+    int cx0 = std::max(0, (x - radius) / cell), cx1 = std::min(cols - 1, (x + radius) / cell);
+    int cy0 = std::max(0, (y - radius) / cell), cy1 = std::min(rows - 1, (y + radius) / cell);
+
+    for (int cy = cy0; cy <= cy1; ++cy) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            size_t c = static_cast<size_t>(cy) * cols + cx;
+            for (uint32_t i = cell_start[c]; i < cell_start[c + 1]; ++i) {
+                const Sighting& s = items[i];
+                if (s.npc == exclude || s.kind != kind) continue;
+                long d2 = static_cast<long>(s.x - x) * (s.x - x) + static_cast<long>(s.y - y) * (s.y - y);
+                if (d2 <= best_d2) {
+                    best_d2 = d2;
+                    best = &s;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+bool WorldView::centroid(int x, int y, int radius, Kind kind, const NPC* exclude, int& out_x, int& out_y) const {
+    long sum_x = 0, sum_y = 0, count = 0;
+    long r2 = static_cast<long>(radius) * radius;
+
+    int cx0 = std::max(0, (x - radius) / cell), cx1 = std::min(cols - 1, (x + radius) / cell);
+    int cy0 = std::max(0, (y - radius) / cell), cy1 = std::min(rows - 1, (y + radius) / cell);
+
+    for (int cy = cy0; cy <= cy1; ++cy) {
+        for (int cx = cx0; cx <= cx1; ++cx) {
+            size_t c = static_cast<size_t>(cy) * cols + cx;
+            for (uint32_t i = cell_start[c]; i < cell_start[c + 1]; ++i) {
+                const Sighting& s = items[i];
+                if (s.npc == exclude || s.kind != kind) continue;
+                long d2 = static_cast<long>(s.x - x) * (s.x - x) + static_cast<long>(s.y - y) * (s.y - y);
+                if (d2 > r2) continue;
+                sum_x += s.x;
+                sum_y += s.y;
+                ++count;
+            }
+        }
+    }
+
+    if (count == 0) return false;
+    out_x = static_cast<int>(sum_x / count);
+    out_y = static_cast<int>(sum_y / count);
+    return true;
+}
+
+uint32_t AgentContext::random() {
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return static_cast<uint32_t>((rng * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+bool AgentContext::active() {
+    return random() % 100 < activity;
+}
+
+Step AgentContext::toward(int tx, int ty) const {
+    return {std::clamp(tx - npc->getX(), -speed, speed), std::clamp(ty - npc->getY(), -speed, speed)};
+}
+
+Step AgentContext::approach(int tx, int ty) const {
+    Step s = toward(tx, ty);
+    if (npc->getX() + s.dx == tx && npc->getY() + s.dy == ty) {
+        if (s.dx != 0) s.dx -= sign(s.dx);
+        else s.dy -= sign(s.dy);
+    }
+    return s;
+}
+
+Step AgentContext::away(int fx, int fy) {
+    int dx = sign(npc->getX() - fx);
+    int dy = sign(npc->getY() - fy);
+    while (dx == 0 && dy == 0) {
+        dx = static_cast<int>(random() % 3) - 1;
+        dy = static_cast<int>(random() % 3) - 1;
+    }
+    return {dx * speed, dy * speed};
+}
+
+Step AgentContext::wander() {
+    int dx = static_cast<int>(random() % 3) - 1;
+    int dy = static_cast<int>(random() % 3) - 1;
+    return {dx * speed, dy * speed};
+}
+
+Behaviour patrol(AgentContext* ctx) {
+    while (true) {
+        int tx = 1 + static_cast<int>(ctx->random() % ctx->world->width());
+        int ty = 1 + static_cast<int>(ctx->random() % ctx->world->height());
+
+        for (int t = 0; t < PATROL_LEG_TICKS; ++t) {
+            if (!ctx->active()) {
+                co_yield Step{};
+                continue;
+            }
+            Step s = ctx->toward(tx, ty);
+            co_yield s;
+            if (s.dx == 0 && s.dy == 0) break;
+        }
+    }
+}
+
+Behaviour chase(AgentContext* ctx, Kind prey, int sight) {
+    while (true) {
+        if (!ctx->active()) {
+            co_yield Step{};
+            continue;
+        }
+        const NPC& self = *ctx->npc;
+        if (auto target = ctx->world->nearest(self.getX(), self.getY(), sight, prey, &self)) {
+            co_yield ctx->approach(target->x, target->y);
+        } else {
+            co_yield ctx->wander();
+        }
+    }
+}
+
+Behaviour flee(AgentContext* ctx, Kind threat, int sight) {
+    while (true) {
+        if (!ctx->active()) {
+            co_yield Step{};
+            continue;
+        }
+        const NPC& self = *ctx->npc;
+        int gx, gy;
+        if (auto danger = ctx->world->nearest(self.getX(), self.getY(), sight, threat, &self)) {
+            co_yield ctx->away(danger->x, danger->y);
+        } else if (ctx->world->centroid(self.getX(), self.getY(), sight, ctx->kind, &self, gx, gy)) {
+            co_yield ctx->toward(gx, gy);
+        } else {
+            co_yield ctx->wander();
+        }
+    }
+}
+
+Behaviour groupUp(AgentContext* ctx, int radius) {
+    while (true) {
+        if (!ctx->active()) {
+            co_yield Step{};
+            continue;
+        }
+        const NPC& self = *ctx->npc;
+        int gx, gy;
+        if (ctx->world->centroid(self.getX(), self.getY(), radius, ctx->kind, &self, gx, gy)) {
+            co_yield ctx->toward(gx, gy);
+        } else {
+            co_yield ctx->wander();
+        }
+    }
+}
+
+Behaviour defaultBehaviour(AgentContext* ctx) {
+    switch (ctx->kind) {
+        case Kind::Elf: return chase(ctx, Kind::Robber, 30);
+        case Kind::Bear: return patrol(ctx);
+        case Kind::Robber: return flee(ctx, Kind::Elf, 20);
+    }
+    return groupUp(ctx, 20);
+}
+
+BehaviourScheduler::BehaviourScheduler(size_t worker_threads)
+    : generation(0), remaining(0), stopping(false), view(nullptr)
+{
+    for (size_t i = 1; i < worker_threads; ++i) {
+        workers.emplace_back(&BehaviourScheduler::workerLoop, this, i);
+    }
+}
+
+BehaviourScheduler::~BehaviourScheduler() {
+    {
+        std::lock_guard lock(m);
+        stopping = true;
+    }
+    start_cv.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+void BehaviourScheduler::spawn(const std::shared_ptr<NPC>& npc, int speed, uint32_t activity) {
+    auto ctx = std::make_unique<AgentContext>();
+    ctx->npc = npc;
+    ctx->speed = speed;
+    ctx->activity = activity;
+    ctx->rng = (npc->getId() * 0x9E3779B97F4A7C15ULL) | 1;
+    ctx->kind = npc->getKind();
+
+    std::lock_guard lock(incoming_mutex);
+    incoming.push_back({std::move(ctx), Behaviour{}});
+}
+
+void BehaviourScheduler::runSlice(size_t worker) {
+    size_t slices = workers.size() + 1;
+    size_t chunk = (agents.size() + slices - 1) / slices;
+    size_t begin = std::min(agents.size(), worker * chunk);
+    size_t end = std::min(agents.size(), begin + chunk);
+
+    for (size_t i = begin; i < end; ++i) {
+        agents[i].ctx->world = view;
+        agents[i].behaviour.resume();
+    }
+}
+
+void BehaviourScheduler::workerLoop(size_t worker) {
+    uint64_t seen = 0;
+
+    while (true) {
+        {
+            std::unique_lock lock(m);
+            start_cv.wait(lock, [&]() { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+
+        runSlice(worker);
+
+        std::lock_guard lock(m);
+        if (--remaining == 0) done_cv.notify_one();
+    }
+}
+
+std::vector<BehaviourScheduler::Move> BehaviourScheduler::tick(const WorldView& world) {
+    {
+        std::lock_guard lock(incoming_mutex);
+        for (auto& a : incoming) {
+            a.behaviour = defaultBehaviour(a.ctx.get());
+            agents.push_back(std::move(a));
+        }
+        incoming.clear();
+    }
+
+    agents.erase(std::remove_if(agents.begin(), agents.end(), [](const Agent& a) {
+        return !a.ctx->npc->isAlive() || a.behaviour.done();
+    }), agents.end());
+
+    view = &world;
+
+    {
+        std::lock_guard lock(m);
+        remaining = workers.size();
+        ++generation;
+    }
+    start_cv.notify_all();
+
+    runSlice(0);
+
+    {
+        std::unique_lock lock(m);
+        done_cv.wait(lock, [this]() { return remaining == 0; });
+    }
+
+    std::vector<Move> moves;
+    for (const auto& a : agents) {
+        if (a.behaviour.done()) continue;
+        Step s = a.behaviour.step();
+        if (s.dx != 0 || s.dy != 0) {
+            moves.push_back({a.ctx->npc, s});
+        }
+    }
+    return moves;
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <coroutine>
+#include <exception>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include "../npc.h"
+
+struct Step {
+    int dx = 0;
+    int dy = 0;
+};
+
+class FramePool {
+public:
+    static void* allocate(size_t size);
+    static void deallocate(void* p, size_t size);
+};
+
+class Behaviour {
+public:
+    struct promise_type {
+        Step step;
+        std::exception_ptr error;
+
+        Behaviour get_return_object() {
+            return Behaviour(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(Step s) noexcept {
+            step = s;
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+
+        static void* operator new(size_t size) { return FramePool::allocate(size); }
+        static void operator delete(void* p, size_t size) { FramePool::deallocate(p, size); }
+    };
+
+private:
+    std::coroutine_handle<promise_type> h;
+
+public:
+    Behaviour() = default;
+    explicit Behaviour(std::coroutine_handle<promise_type> handle) : h(handle) {}
+    Behaviour(Behaviour&& o) noexcept : h(o.h) { o.h = nullptr; }
+    Behaviour& operator=(Behaviour&& o) noexcept;
+    Behaviour(const Behaviour&) = delete;
+    Behaviour& operator=(const Behaviour&) = delete;
+    ~Behaviour();
+
+    bool resume();
+    Step step() const { return h ? h.promise().step : Step{}; }
+    bool done() const { return !h || h.done(); }
+};
+
+class WorldView {
+public:
+    struct Sighting {
+        const NPC* npc;
+        int x, y;
+        Kind kind;
+    };
+
+private:
+    int w, h, cell;
+    int cols, rows;
+    std::vector<Sighting> items;
+    std::vector<uint32_t> cell_start;
+
+public:
+    WorldView(int width, int height, int cell_size);
+
+    void rebuild(const std::vector<std::shared_ptr<NPC>>& npcs);
+
+    const Sighting* nearest(int x, int y, int radius, Kind kind, const NPC* exclude) const;
+    bool centroid(int x, int y, int radius, Kind kind, const NPC* exclude, int& cx, int& cy) const;
+
+    int width() const { return w; }
+    int height() const { return h; }
+    size_t size() const { return items.size(); }
+};
+
+struct AgentContext {
+    std::shared_ptr<NPC> npc;
+    const WorldView* world = nullptr;
+    int speed = 5;
+    uint32_t activity = 100;
+    uint64_t rng = 0;
+    Kind kind = Kind::Bear;
+
+    uint32_t random();
+    bool active();
+    Step toward(int tx, int ty) const;
+    Step approach(int tx, int ty) const;
+    Step away(int fx, int fy);
+    Step wander();
+};
+
+Behaviour patrol(AgentContext* ctx);
+Behaviour chase(AgentContext* ctx, Kind prey, int sight);
+Behaviour flee(AgentContext* ctx, Kind threat, int sight);
+Behaviour groupUp(AgentContext* ctx, int radius);
+Behaviour defaultBehaviour(AgentContext* ctx);
+
+class BehaviourScheduler {
+public:
+    struct Move {
+        std::shared_ptr<NPC> npc;
+        Step step;
+    };
+
+private:
+    struct Agent {
+        std::unique_ptr<AgentContext> ctx;
+        Behaviour behaviour;
+    };
+
+    std::vector<Agent> agents;
+    std::vector<Agent> incoming;
+    std::mutex incoming_mutex;
+
+    std::vector<std::thread> workers;
+    std::mutex m;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    uint64_t generation;
+    size_t remaining;
+    bool stopping;
+    const WorldView* view;
+
+    void runSlice(size_t worker);
+    void workerLoop(size_t worker);
+
+public:
+    explicit BehaviourScheduler(size_t worker_threads = std::thread::hardware_concurrency());
+    ~BehaviourScheduler();
+
+    void spawn(const std::shared_ptr<NPC>& npc, int speed, uint32_t activity);
+    std::vector<Move> tick(const WorldView& world);
+
+    size_t size() const { return agents.size(); }
+};
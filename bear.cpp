@@ -1,5 +1,3 @@
 #include "npc.h"
-#include "visitor/visitor.h"
 
-std::string Bear::type() const { return "Bear"; }
-void Bear::accept(FightVisitor& v) { v.visit(*this); }
\ No newline at end of file
+std::string Bear::type() const { return kindName(KIND); }
\ No newline at end of file
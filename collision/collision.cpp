@@ -0,0 +1,145 @@
+#include "collision.h"
+#include <cmath>
+#include <algorithm>
+
+ContactTracker::ContactTracker(double distance)
+    : dist(distance), cell_size(std::max(1, static_cast<int>(std::ceil(distance)))),
+      contact_count(0)
+{}
+
+uint64_t ContactTracker::cellOf(int x, int y) const {
+    uint32_t cx = static_cast<uint32_t>(x / cell_size);
+    uint32_t cy = static_cast<uint32_t>(y / cell_size);
+    return (static_cast<uint64_t>(cx) << 32) | cy;
+}
+
+void ContactTracker::insertIntoCell(NPC* npc, uint64_t cell) {
+    grid[cell].push_back(npc);
+}
+
+void ContactTracker::eraseFromCell(NPC* npc, uint64_t cell) {
+    auto it = grid.find(cell);
+    if (it == grid.end()) return;
+
+    auto& bucket = it->second;
+    auto pos = std::find(bucket.begin(), bucket.end(), npc);
+    if (pos != bucket.end()) {
+        *pos = bucket.back();
+        bucket.pop_back();
+    }
+    if (bucket.empty()) grid.erase(it);
+}
+
+bool ContactTracker::inRange(const NPC& a, const NPC& b) const {
+    return std::hypot(a.getX() - b.getX(), a.getY() - b.getY()) <= dist;
+}
+
+void ContactTracker::relocate(Entry& e) {
+    e.x = e.npc->getX();
+    e.y = e.npc->getY();
+    uint64_t cell = cellOf(e.x, e.y);
+    if (cell != e.cell) {
+        eraseFromCell(e.npc.get(), e.cell);
+        insertIntoCell(e.npc.get(), cell);
+        e.cell = cell;
+    }
+}
+
+void ContactTracker::add(const std::shared_ptr<NPC>& npc) {
+    NPC* key = npc.get();
+    if (!key || entries.count(key)) return;
+
+    int x = npc->getX();
+    int y = npc->getY();
+    uint64_t cell = cellOf(x, y);
+    entries.emplace(key, Entry{npc, x, y, cell, {}});
+    insertIntoCell(key, cell);
+    dirty.insert(key);
+}
+
+void ContactTracker::remove(const std::shared_ptr<NPC>& npc) {
+    auto it = entries.find(npc.get());
+    if (it == entries.end()) return;
+
+    Entry& e = it->second;
+    for (NPC* other : e.contacts) {
+        entries.at(other).contacts.erase(npc.get());
+        --contact_count;
+    }
+    eraseFromCell(npc.get(), e.cell);
+    dirty.erase(npc.get());
+    entries.erase(it);
+}
+
+void ContactTracker::markMoved(const std::shared_ptr<NPC>& npc) {
+    if (entries.count(npc.get())) {
+        dirty.insert(npc.get());
+    }
+}
+
+void ContactTracker::forget(const std::shared_ptr<NPC>& a, const std::shared_ptr<NPC>& b) {
+    auto ia = entries.find(a.get());
+    auto ib = entries.find(b.get());
+    if (ia == entries.end() || ib == entries.end()) return;
+
+    if (ia->second.contacts.erase(b.get())) {
+        ib->second.contacts.erase(a.get());
+        --contact_count;
+    }
+    dirty.insert(a.get());
+    dirty.insert(b.get());
+}
+
+void ContactTracker::clear() {
+    entries.clear();
+    grid.clear();
+    dirty.clear();
+    contact_count = 0;
+}
+
+std::vector<ContactTracker::Contact> ContactTracker::update() {
+    std::vector<Contact> found;
+    if (dirty.empty()) return found;
+
+    for (NPC* d : dirty) {
+        relocate(entries.at(d));
+    }
+
+    for (NPC* d : dirty) {
+        Entry& e = entries.at(d);
+
+        for (auto c = e.contacts.begin(); c != e.contacts.end();) {
+            if (!inRange(*d, **c)) {
+                entries.at(*c).contacts.erase(d);
+                c = e.contacts.erase(c);
+                --contact_count;
+            } else {
+                ++c;
+            }
+        }
+
+        int cx = e.x / cell_size;
+        int cy = e.y / cell_size;
+        for (int gx = cx - 1; gx <= cx + 1; ++gx) {
+            for (int gy = cy - 1; gy <= cy + 1; ++gy) {
+                if (gx < 0 || gy < 0) continue;
+                auto cell = grid.find((static_cast<uint64_t>(gx) << 32) | static_cast<uint32_t>(gy));
+                if (cell == grid.end()) continue;
+
+                for (NPC* other : cell->second) {
+                    if (other == d || e.contacts.count(other)) continue;
+                    if (!inRange(*d, *other)) continue;
+
+                    Entry& o = entries.at(other);
+                    e.contacts.insert(other);
+                    o.contacts.insert(d);
+                    ++contact_count;
+                    found.emplace_back(e.npc, o.npc);
+                }
+            }
+        }
+    }
+
+    dirty.clear();
+    return found;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+#include "../npc.h"
+
+class ContactTracker {
+public:
+    using Contact = std::pair<std::shared_ptr<NPC>, std::shared_ptr<NPC>>;
+
+private:
+    struct Entry {
+        std::shared_ptr<NPC> npc;
+        int x, y;
+        uint64_t cell;
+        std::unordered_set<NPC*> contacts;
+    };
+
+    double dist;
+    int cell_size;
+
+    std::unordered_map<NPC*, Entry> entries;
+    std::unordered_map<uint64_t, std::vector<NPC*>> grid;
+    std::unordered_set<NPC*> dirty;
+    size_t contact_count;
+
+    uint64_t cellOf(int x, int y) const;
+    void insertIntoCell(NPC* npc, uint64_t cell);
+    void eraseFromCell(NPC* npc, uint64_t cell);
+    bool inRange(const NPC& a, const NPC& b) const;
+    void relocate(Entry& e);
+
+public:
+    explicit ContactTracker(double distance);
+
+    void add(const std::shared_ptr<NPC>& npc);
+    void remove(const std::shared_ptr<NPC>& npc);
+    void markMoved(const std::shared_ptr<NPC>& npc);
+    void forget(const std::shared_ptr<NPC>& a, const std::shared_ptr<NPC>& b);
+    void clear();
+
+    std::vector<Contact> update();
+
+    size_t size() const { return entries.size(); }
+    size_t contactCount() const { return contact_count; }
+    size_t dirtyCount() const { return dirty.size(); }
+};
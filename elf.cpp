@@ -1,5 +1,3 @@
 #include "npc.h"
-#include "visitor/visitor.h"
 
-std::string Elf::type() const { return "Elf"; }
-void Elf::accept(FightVisitor& v) { v.visit(*this); }
\ No newline at end of file
+std::string Elf::type() const { return kindName(KIND); }
\ No newline at end of file
@@ -3,10 +3,108 @@
 #include <sstream>
 #include <iostream>
 #include <random>
+#include <thread>
+#include <exception>
+#include <stdexcept>
+#include <cmath>
+
+namespace {
+
+constexpr size_t MIN_BATCH_PER_THREAD = 4096;
+
+std::mt19937& threadGenerator() {
+    thread_local std::mt19937 gen(std::random_device{}());
+    return gen;
+}
+
+std::shared_ptr<NPC> makeNPC(int kind, const std::string& name, int x, int y, int attack, int defense) {
+    switch (kind) {
+        case 0: return std::make_shared<Bear>(name, x, y, attack, defense);
+        case 1: return std::make_shared<Elf>(name, x, y, attack, defense);
+        default: return std::make_shared<Robber>(name, x, y, attack, defense);
+    }
+}
+
+class PositionSampler {
+    const PlacementStrategy& p;
+    std::uniform_int_distribution<> x_dist;
+    std::uniform_int_distribution<> y_dist;
+    std::vector<std::pair<int, int>> centers;
+    std::uniform_int_distribution<size_t> center_dist;
+    std::normal_distribution<double> offset_dist;
+    std::discrete_distribution<size_t> cell_dist;
+    std::uniform_real_distribution<double> in_cell;
+
+public:
+    PositionSampler(const PlacementStrategy& placement, std::mt19937& gen)
+        : p(placement), in_cell(0.0, 1.0)
+    {
+        if (p.width <= 0 || p.width > 500 || p.height <= 0 || p.height > 500) {
+            throw std::invalid_argument("Размер области размещения должен быть в диапазоне (0, 500]");
+        }
+        x_dist = std::uniform_int_distribution<>(1, p.width);
+        y_dist = std::uniform_int_distribution<>(1, p.height);
+
+        if (p.kind == Placement::Clustered) {
+            if (!std::isfinite(p.cluster_radius) || p.cluster_radius <= 0) {
+                throw std::invalid_argument("Радиус кластера должен быть положительным");
+            }
+            offset_dist = std::normal_distribution<double>(0.0, p.cluster_radius);
+            int clusters = std::max(1, p.clusters);
+            for (int i = 0; i < clusters; ++i) {
+                centers.emplace_back(x_dist(gen), y_dist(gen));
+            }
+            center_dist = std::uniform_int_distribution<size_t>(0, centers.size() - 1);
+        }
+
+        if (p.kind == Placement::DensityMap) {
+            if (p.density_cols <= 0 || p.density_rows <= 0 ||
+                p.density.size() != static_cast<size_t>(p.density_cols) * p.density_rows) {
+                throw std::invalid_argument("Размер карты плотности не совпадает с density_cols x density_rows");
+            }
+            double total = 0;
+            for (double w : p.density) {
+                if (!std::isfinite(w) || w < 0) {
+                    throw std::invalid_argument("Веса карты плотности должны быть неотрицательными");
+                }
+                total += w;
+            }
+            if (total <= 0) {
+                throw std::invalid_argument("Веса карты плотности не должны быть все нулевыми");
+            }
+            cell_dist = std::discrete_distribution<size_t>(p.density.begin(), p.density.end());
+        }
+    }
+
+    std::pair<int, int> operator()(std::mt19937& gen) {
+        switch (p.kind) {
+            case Placement::Clustered: {
+                auto [cx, cy] = centers[center_dist(gen)];
+                int x = static_cast<int>(std::lround(cx + offset_dist(gen)));
+                int y = static_cast<int>(std::lround(cy + offset_dist(gen)));
+                return {std::clamp(x, 1, p.width), std::clamp(y, 1, p.height)};
+            }
+            case Placement::DensityMap: {
+                size_t cell = cell_dist(gen);
+                double cell_w = static_cast<double>(p.width) / p.density_cols;
+                double cell_h = static_cast<double>(p.height) / p.density_rows;
+                int col = static_cast<int>(cell % p.density_cols);
+                int row = static_cast<int>(cell / p.density_cols);
+                int x = 1 + static_cast<int>((col + in_cell(gen)) * cell_w);
+                int y = 1 + static_cast<int>((row + in_cell(gen)) * cell_h);
+                return {std::clamp(x, 1, p.width), std::clamp(y, 1, p.height)};
+            }
+            case Placement::Uniform:
+            default:
+                return {x_dist(gen), y_dist(gen)};
+        }
+    }
+};
+
+}
 
 std::shared_ptr<NPC> NPCFactory::create(const std::string& type, const std::string& name, int x, int y) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    std::mt19937& gen = threadGenerator();
     std::uniform_int_distribution<> attack_dist(15, 35);
     std::uniform_int_distribution<> defense_dist(10, 30);
     
@@ -23,11 +121,9 @@ std::shared_ptr<NPC> NPCFactory::create(const std::string& type, const std::stri
 }
 
 std::shared_ptr<NPC> NPCFactory::createRandom(const std::string& name, int x, int y) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
     std::uniform_int_distribution<> type_dist(0, 2);
     
-    switch(type_dist(gen)) {
+    switch(type_dist(threadGenerator())) {
         case 0: return create("bear", name, x, y);
         case 1: return create("elf", name, x, y);
         case 2: return create("robber", name, x, y);
@@ -35,6 +131,88 @@ std::shared_ptr<NPC> NPCFactory::createRandom(const std::string& name, int x, in
     }
 }
 
+std::vector<std::shared_ptr<NPC>> NPCFactory::createBatch(const SpawnConfig& config) {
+    std::vector<std::shared_ptr<NPC>> npcs;
+    appendBatch(config, npcs);
+    return npcs;
+}
+
+void NPCFactory::appendBatch(const SpawnConfig& config, std::vector<std::shared_ptr<NPC>>& out) {
+    if (config.count == 0) return;
+
+    const TypeDistribution& t = config.types;
+    if (t.bear < 0 || t.elf < 0 || t.robber < 0 || t.bear + t.elf + t.robber <= 0) {
+        throw std::invalid_argument("Веса типов NPC должны быть неотрицательными и не все нулевыми");
+    }
+    const StatDistribution& s = config.stats;
+    if (s.attack_min > s.attack_max || s.defense_min > s.defense_max) {
+        throw std::invalid_argument("Некорректный диапазон характеристик NPC");
+    }
+
+    uint64_t seed = config.seed;
+    if (seed == 0) {
+        std::random_device rd;
+        seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+    }
+
+    std::mt19937 setup_gen(static_cast<std::mt19937::result_type>(seed));
+    const PositionSampler sampler(config.placement, setup_gen);
+    const std::discrete_distribution<int> type_dist({t.bear, t.elf, t.robber});
+    const std::uniform_int_distribution<> attack_dist(s.attack_min, s.attack_max);
+    const std::uniform_int_distribution<> defense_dist(s.defense_min, s.defense_max);
+
+    const size_t offset = out.size();
+    out.resize(offset + config.count);
+
+    auto fill = [&](size_t begin, size_t end, unsigned worker) {
+        std::seed_seq seq{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32), worker};
+        std::mt19937 gen(seq);
+        PositionSampler position = sampler;
+        auto kind = type_dist;
+        auto attack = attack_dist;
+        auto defense = defense_dist;
+
+        for (size_t i = begin; i < end; ++i) {
+            auto [x, y] = position(gen);
+            std::string name = config.name_prefix + std::to_string(config.first_index + i);
+            out[offset + i] = makeNPC(kind(gen), name, x, y, attack(gen), defense(gen));
+        }
+    };
+
+    size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    size_t workers = std::clamp<size_t>(config.count / MIN_BATCH_PER_THREAD, 1, hw);
+    size_t chunk = (config.count + workers - 1) / workers;
+
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(workers);
+    for (size_t w = 1; w < workers; ++w) {
+        size_t begin = w * chunk;
+        size_t end = std::min(config.count, begin + chunk);
+        threads.emplace_back([&, begin, end, w]() {
+            try {
+                fill(begin, end, static_cast<unsigned>(w));
+            } catch (...) {
+                errors[w] = std::current_exception();
+            }
+        });
+    }
+
+    try {
+        fill(0, std::min(config.count, chunk), 0);
+    } catch (...) {
+        errors[0] = std::current_exception();
+    }
+
+    for (auto& th : threads) th.join();
+
+    for (auto& e : errors) {
+        if (e) {
+            out.resize(offset);
+            std::rethrow_exception(e);
+        }
+    }
+}
+
 std::vector<std::shared_ptr<NPC>> NPCFactory::loadFromFile(const std::string& filename) {
     std::vector<std::shared_ptr<NPC>> npcs;
     std::ifstream file(filename);
@@ -2,12 +2,57 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <cstdint>
 #include "../npc.h"
 
+struct TypeDistribution {
+    double bear = 1.0;
+    double elf = 1.0;
+    double robber = 1.0;
+};
+
+struct StatDistribution {
+    int attack_min = 15;
+    int attack_max = 35;
+    int defense_min = 10;
+    int defense_max = 30;
+};
+
+enum class Placement {
+    Uniform,
+    Clustered,
+    DensityMap
+};
+
+struct PlacementStrategy {
+    Placement kind = Placement::Uniform;
+    int width = 100;
+    int height = 100;
+
+    int clusters = 5;
+    double cluster_radius = 8.0;
+
+    int density_cols = 0;
+    int density_rows = 0;
+    std::vector<double> density;
+};
+
+struct SpawnConfig {
+    size_t count = 0;
+    TypeDistribution types;
+    StatDistribution stats;
+    PlacementStrategy placement;
+    std::string name_prefix = "NPC_";
+    size_t first_index = 1;
+    uint64_t seed = 0;
+};
+
 class NPCFactory {
 public:
     static std::shared_ptr<NPC> create(const std::string& type, const std::string& name, int x, int y);
     static std::shared_ptr<NPC> createRandom(const std::string& name, int x, int y);
+    static std::vector<std::shared_ptr<NPC>> createBatch(const SpawnConfig& config);
+    static void appendBatch(const SpawnConfig& config, std::vector<std::shared_ptr<NPC>>& out);
     static std::vector<std::shared_ptr<NPC>> loadFromFile(const std::string& filename);
     static void saveToFile(const std::string& filename, const std::vector<std::shared_ptr<NPC>>& npcs);
 };
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "fightqueue.h"
+#include <algorithm>
+
+FightQueue::FightQueue(size_t cap) : capacity(cap), closed(false) {}
+
+FightQueue::Key FightQueue::keyOf(const NPC& a, const NPC& b) {
+    return {std::min(a.getId(), b.getId()), std::max(a.getId(), b.getId())};
+}
+
+bool FightQueue::isStale(const Entry& e) {
+    return !e.fight.first->isAlive() || !e.fight.second->isAlive();
+}
+
+bool FightQueue::hasMoved(const Entry& e) {
+    return e.fight.first->getGeneration() != e.gen_a || e.fight.second->getGeneration() != e.gen_b;
+}
+
+bool FightQueue::enqueue(Fight& fight) {
+    if (!fight.first || !fight.second) return false;
+    
+    ++counters.pushed;
+    
+    if (!fight.first->isAlive() || !fight.second->isAlive()) {
+        ++counters.stale;
+        return false;
+    }
+    
+    Key key = keyOf(*fight.first, *fight.second);
+    if (pending.count(key)) {
+        ++counters.duplicates;
+        return false;
+    }
+    
+    if (entries.size() >= capacity) {
+        ++counters.overflow;
+        return false;
+    }
+    
+    uint32_t gen_a = fight.first->getGeneration();
+    uint32_t gen_b = fight.second->getGeneration();
+    pending.insert(key);
+    entries.push_back({std::move(fight), gen_a, gen_b, key});
+    counters.max_depth = std::max(counters.max_depth, entries.size());
+    return true;
+}
+
+bool FightQueue::push(Fight fight) {
+    bool added;
+    {
+        std::lock_guard lock(m);
+        if (closed) return false;
+        added = enqueue(fight);
+    }
+    if (added) cv.notify_one();
+    return added;
+}
+
+size_t FightQueue::pushBatch(std::vector<Fight>& fights, std::vector<Fight>* rejected) {
+    size_t added = 0;
+    {
+        std::lock_guard lock(m);
+        if (closed) return 0;
+        ++counters.batches;
+        for (auto& fight : fights) {
+            uint64_t overflow = counters.overflow;
+            if (enqueue(fight)) {
+                ++added;
+            } else if (rejected && counters.overflow != overflow) {
+                rejected->push_back(std::move(fight));
+            }
+        }
+    }
+    fights.clear();
+    
+    if (added == 1) cv.notify_one();
+    else if (added > 1) cv.notify_all();
+    return added;
+}
+
+bool FightQueue::pop(Fight& out, bool* moved) {
+    std::unique_lock lock(m);
+    
+    while (true) {
+        cv.wait(lock, [this]() { return !entries.empty() || closed; });
+        if (closed) return false;
+        
+        Entry e = std::move(entries.front());
+        entries.pop_front();
+        pending.erase(e.key);
+        
+        if (isStale(e)) {
+            ++counters.stale;
+            continue;
+        }
+        
+        ++counters.processed;
+        if (moved) *moved = hasMoved(e);
+        out = std::move(e.fight);
+        return true;
+    }
+}
+
+size_t FightQueue::popBatch(std::vector<Fight>& out, size_t max, std::vector<uint8_t>* moved) {
+    out.clear();
+    if (moved) moved->clear();
+    std::unique_lock lock(m);
+    
+    while (out.empty()) {
+        cv.wait(lock, [this]() { return !entries.empty() || closed; });
+        if (closed) return 0;
+        
+        while (!entries.empty() && out.size() < max) {
+            Entry e = std::move(entries.front());
+            entries.pop_front();
+            pending.erase(e.key);
+            
+            if (isStale(e)) {
+                ++counters.stale;
+                continue;
+            }
+            
+            ++counters.processed;
+            if (moved) moved->push_back(hasMoved(e));
+            out.push_back(std::move(e.fight));
+        }
+    }
+    return out.size();
+}
+
+void FightQueue::reportStale(size_t count) {
+    std::lock_guard lock(m);
+    counters.stale += count;
+    counters.processed -= std::min<uint64_t>(counters.processed, count);
+}
+
+void FightQueue::close() {
+    {
+        std::lock_guard lock(m);
+        closed = true;
+        entries.clear();
+        pending.clear();
+    }
+    cv.notify_all();
+}
+
+size_t FightQueue::size() const {
+    std::lock_guard lock(m);
+    return entries.size();
+}
+
+FightQueueStats FightQueue::stats() const {
+    std::lock_guard lock(m);
+    FightQueueStats s = counters;
+    s.depth = entries.size();
+    return s;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_set>
+#include <cstdint>
+#include "../npc.h"
+
+struct FightQueueStats {
+    uint64_t pushed = 0;
+    uint64_t duplicates = 0;
+    uint64_t stale = 0;
+    uint64_t overflow = 0;
+    uint64_t processed = 0;
+    uint64_t batches = 0;
+    size_t depth = 0;
+    size_t max_depth = 0;
+};
+
+class FightQueue {
+public:
+    using Fight = std::pair<std::shared_ptr<NPC>, std::shared_ptr<NPC>>;
+
+private:
+    struct Key {
+        uint64_t lo, hi;
+        bool operator==(const Key& o) const { return lo == o.lo && hi == o.hi; }
+    };
+    
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            return std::hash<uint64_t>()(k.lo * 0x9E3779B97F4A7C15ULL ^ k.hi);
+        }
+    };
+    
+    struct Entry {
+        Fight fight;
+        uint32_t gen_a, gen_b;
+        Key key;
+    };
+    
+    std::deque<Entry> entries;
+    std::unordered_set<Key, KeyHash> pending;
+    size_t capacity;
+    bool closed;
+    
+    FightQueueStats counters;
+    
+    mutable std::mutex m;
+    std::condition_variable cv;
+    
+    static Key keyOf(const NPC& a, const NPC& b);
+    static bool isStale(const Entry& e);
+    static bool hasMoved(const Entry& e);
+    bool enqueue(Fight& fight);
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+    
+    explicit FightQueue(size_t capacity = DEFAULT_CAPACITY);
+    
+    bool push(Fight fight);
+    size_t pushBatch(std::vector<Fight>& fights, std::vector<Fight>* rejected = nullptr);
+    bool pop(Fight& out, bool* moved = nullptr);
+    size_t popBatch(std::vector<Fight>& out, size_t max, std::vector<uint8_t>* moved = nullptr);
+    void reportStale(size_t count);
+    void close();
+    
+    size_t size() const;
+    FightQueueStats stats() const;
+};
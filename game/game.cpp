@@ -5,191 +5,261 @@
 #include <cmath>
 #include <algorithm>
 #include <iomanip>
+#include <sstream>
+#include <iterator>
 #include "../npc.h"
 #include "../factory/factory.h"
+#include "../visitor/kernel.h"
 
-Game::Game() : running(false), stop_requested(false) {
+Game::Game(const std::string& journal_file) : contacts(KILL_DISTANCE), stats(MAP_WIDTH, MAP_HEIGHT), journal(journal_file), running(false), stop_requested(false), next_npc_index(1), reinforcement_interval(0) {
+    if (!journal.isOpen()) {
+        logWarn("Не удалось создать журнал {} (файл уже существует или недоступен), запись отключена", journal_file);
+    }
+    if (publisher.open(SHM_NAME, SHM_CAPACITY)) {
+        logInfo("Состояние мира публикуется в общую память {}", SHM_NAME);
+    }
     initializeNPCs();
 }
 
+std::string Game::defaultJournalFile() {
+    auto now = std::chrono::system_clock::now();
+    auto time = std::chrono::system_clock::to_time_t(now);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+    
+    std::ostringstream name;
+    name << "journal_" << std::put_time(std::localtime(&time), "%Y%m%d_%H%M%S")
+         << "_" << std::setw(3) << std::setfill('0') << ms << ".bin";
+    return name.str();
+}
+
 Game::~Game() {
     stop();
 }
 
+SpawnConfig Game::makeSpawnConfig(size_t count) {
+    SpawnConfig config;
+    config.count = count;
+    config.placement.width = MAP_WIDTH;
+    config.placement.height = MAP_HEIGHT;
+    config.first_index = next_npc_index.fetch_add(count);
+    return config;
+}
+
 void Game::initializeNPCs() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> coord(1, MAP_WIDTH);
+    auto batch = NPCFactory::createBatch(makeSpawnConfig(INITIAL_NPC_COUNT));
     
     std::unique_lock lock(npcs_mutex);
+    npcs = std::move(batch);
     
-    for (int i = 0; i < 50; ++i) {
-        int x = coord(gen);
-        int y = coord(gen);
-        std::string name = "NPC_" + std::to_string(i + 1);
-        
-        auto npc = NPCFactory::createRandom(name, x, y);
-        if (npc) {
-            npcs.push_back(npc);
-        }
+    {
+        std::lock_guard contacts_lock(contacts_mutex);
+        for (const auto& npc : npcs) contacts.add(npc);
+    }
+    for (const auto& npc : npcs) {
+        registerBehaviour(npc);
+        stats.onSpawn(*npc);
+        journal.spawn(*npc);
     }
     
-    std::cout << "Создано " << npcs.size() << " NPC" << std::endl;
-    std::cout << "Эльфы двигаются на " << ELF_MOVE_DISTANCE << " клеток" << std::endl;
-    std::cout << "Дистанция боя " << KILL_DISTANCE << " клеток" << std::endl;
+    logInfo("Создано {} NPC", npcs.size());
+    logInfo("Эльфы двигаются на {} клеток", ELF_MOVE_DISTANCE);
+    logInfo("Дистанция боя {} клеток", KILL_DISTANCE);
 }
 
-void Game::movementWorker() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> move_dir(-1, 1);
-    std::uniform_int_distribution<> move_chance(0, 100);
+void Game::spawnWave(size_t count, const PlacementStrategy& placement) {
+    SpawnConfig config = makeSpawnConfig(count);
+    config.placement = placement;
+    config.placement.width = MAP_WIDTH;
+    config.placement.height = MAP_HEIGHT;
+    config.name_prefix = "WAVE_";
+    
+    auto batch = NPCFactory::createBatch(config);
     
     {
-        std::lock_guard lock(cout_mutex);
-        std::cout << "Запущен поток движения" << std::endl;
+        std::unique_lock lock(npcs_mutex);
+        std::lock_guard contacts_lock(contacts_mutex);
+        for (const auto& npc : batch) {
+            contacts.add(npc);
+            registerBehaviour(npc);
+            stats.onSpawn(*npc);
+            journal.spawn(*npc);
+        }
+        npcs.reserve(npcs.size() + batch.size());
+        std::move(batch.begin(), batch.end(), std::back_inserter(npcs));
     }
     
+    logInfo("Прибыло подкрепление: {} NPC", count);
+}
+
+void Game::setReinforcementInterval(int seconds) {
+    reinforcement_interval = std::max(0, seconds);
+}
+
+void Game::registerBehaviour(const std::shared_ptr<NPC>& npc) {
+    if (npc->getKind() == Kind::Elf) {
+        behaviours.spawn(npc, ELF_MOVE_DISTANCE, 100);
+    } else {
+        behaviours.spawn(npc, MOVE_DISTANCE, MOVE_CHANCE);
+    }
+}
+
+void Game::movementWorker() {
+    WorldView world(MAP_WIDTH, MAP_HEIGHT, AI_CELL_SIZE);
+    uint32_t tick = 0;
+    
+    logDebug("Запущен поток движения");
+    
     while (running && !stop_requested) {
-        std::vector<std::shared_ptr<NPC>> npcs_copy;
+        journal.tick(++tick);
         
         {
             std::shared_lock lock(npcs_mutex);
-            npcs_copy = npcs;
+            world.rebuild(npcs);
+            if (tick % KEYFRAME_INTERVAL == 0) {
+                journal.keyframe(tick, npcs);
+            }
         }
         
-        for (auto& npc : npcs_copy) {
-            {
-                std::shared_lock lock(npcs_mutex);
-                auto it = std::find(npcs.begin(), npcs.end(), npc);
-                if (it == npcs.end()) continue; 
-            }
-            
-            bool should_move = false;
-            int move_distance = 0;
-            
-            if (npc->type() == "Elf") {
-                should_move = true;
-                move_distance = ELF_MOVE_DISTANCE;
-            } else if (move_chance(gen) < 30) {
-                should_move = true;
-                move_distance = 5;
-            }
+        auto moves = behaviours.tick(world);
+        
+        if (!moves.empty()) {
+            std::unique_lock lock(npcs_mutex);
+            std::lock_guard contacts_lock(contacts_mutex);
             
-            if (should_move) {
-                int dx = move_dir(gen) * move_distance;
-                int dy = move_dir(gen) * move_distance;
+            for (auto& m : moves) {
+                if (!m.npc->isAlive()) continue;
                 
-                int new_x = npc->getX() + dx;
-                int new_y = npc->getY() + dy;
+                int new_x = std::clamp(m.npc->getX() + m.step.dx, 1, MAP_WIDTH);
+                int new_y = std::clamp(m.npc->getY() + m.step.dy, 1, MAP_HEIGHT);
+                if (new_x == m.npc->getX() && new_y == m.npc->getY()) continue;
                 
-                if (new_x >= 1 && new_x <= MAP_WIDTH && 
-                    new_y >= 1 && new_y <= MAP_HEIGHT) {
-                    
-                    std::unique_lock lock(npcs_mutex);
-                    npc->move(dx, dy);
-                }
+                m.npc->move(new_x - m.npc->getX(), new_y - m.npc->getY());
+                contacts.markMoved(m.npc);
+                stats.onMove(*m.npc);
+                journal.move(*m.npc);
             }
         }
         
+        std::vector<ContactTracker::Contact> new_contacts, rejected;
         {
             std::shared_lock lock(npcs_mutex);
-            for (size_t i = 0; i < npcs.size(); ++i) {
-                for (size_t j = i + 1; j < npcs.size(); ++j) {
-                    double dist = std::hypot(
-                        npcs[i]->getX() - npcs[j]->getX(),
-                        npcs[i]->getY() - npcs[j]->getY()
-                    );
-                    
-                    if (dist <= KILL_DISTANCE) {
-                        std::lock_guard fight_lock(fight_mutex);
-                        fight_queue.push({npcs[i], npcs[j]});
-                        fight_cv.notify_one();
-                    }
-                }
+            std::lock_guard contacts_lock(contacts_mutex);
+            new_contacts = contacts.update();
+        }
+        
+        if (!new_contacts.empty()) {
+            fight_queue.pushBatch(new_contacts, &rejected);
+            if (!rejected.empty()) {
+                std::lock_guard contacts_lock(contacts_mutex);
+                for (const auto& [a, b] : rejected) contacts.forget(a, b);
+                rejected.clear();
             }
         }
         
+        if (publisher.isOpen()) {
+            int alive[KIND_COUNT], dead[KIND_COUNT];
+            for (Kind k : {Kind::Bear, Kind::Elf, Kind::Robber}) {
+                alive[static_cast<size_t>(k)] = stats.aliveCount(k);
+                dead[static_cast<size_t>(k)] = stats.deadCount(k);
+            }
+            
+            std::shared_lock lock(npcs_mutex);
+            publisher.publish(tick, npcs, alive, dead);
+        }
+        
         std::this_thread::sleep_for(std::chrono::milliseconds(200));
     }
     
-    {
-        std::lock_guard lock(cout_mutex);
-        std::cout << "Остановлен поток движения" << std::endl;
-    }
+    logDebug("Остановлен поток движения");
 }
 
-void Game::processFight(std::shared_ptr<NPC> attacker, std::shared_ptr<NPC> defender) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dice(1, 6); 
+bool Game::processFight(std::shared_ptr<NPC> attacker, std::shared_ptr<NPC> defender,
+                        int attack_power, int defense_power, uint8_t outcome) {
+    if (!attacker->isAlive() || !defender->isAlive()) return false;
     
-    int attack_power = dice(gen); 
-    int defense_power = dice(gen);
+    logInfo("{} атакует {} (Атака: {} vs Защита: {})",
+            attacker->getName(), defender->getName(), attack_power, defense_power);
     
-    {
-        std::lock_guard lock(cout_mutex);
-        std::cout << attacker->getName() << " атакует " << defender->getName() 
-                  << " (Атака: " << attack_power << " vs Защита: " << defense_power << ")" << std::endl;
-    }
-    
-    if (attack_power > defense_power) {
+    if (outcome & DEFENDER_DIES) {
         std::unique_lock lock(npcs_mutex);
         
         auto it_att = std::find(npcs.begin(), npcs.end(), attacker);
         auto it_def = std::find(npcs.begin(), npcs.end(), defender);
         
         if (it_att != npcs.end() && it_def != npcs.end()) {
+            defender->markDead();
+            stats.onKill(*attacker, *defender);
+            journal.fight(*attacker, *defender, FightOutcome::FirstWins);
+            journal.death(*defender);
             dead_npcs.push_back(defender);
             npcs.erase(it_def);
             
             {
-                std::lock_guard cout_lock(cout_mutex);
-                std::cout << attacker->getName() << " убил " << defender->getName() << std::endl;
+                std::lock_guard contacts_lock(contacts_mutex);
+                contacts.remove(defender);
             }
+            
+            logInfo("{} убил {}", attacker->getName(), defender->getName());
         }
     } else {
-        std::lock_guard lock(cout_mutex);
-        std::cout << defender->getName() << " защитился от " << attacker->getName() << std::endl;
+        journal.fight(*attacker, *defender, FightOutcome::None);
+        logInfo("{} защитился от {}", defender->getName(), attacker->getName());
     }
+    return true;
 }
 
 void Game::fightWorker() {
-    {
-        std::lock_guard lock(cout_mutex);
-        std::cout << "Запущен поток боев" << std::endl;
-    }
+    logDebug("Запущен поток боев");
+    
+    std::vector<FightQueue::Fight> batch;
+    std::vector<uint8_t> moved, attack_rolls, defense_rolls, outcomes;
+    uint64_t seed = (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+    uint64_t counter = 0;
     
     while (running && !stop_requested) {
-        std::pair<std::shared_ptr<NPC>, std::shared_ptr<NPC>> fight_pair;
+        size_t n = fight_queue.popBatch(batch, FIGHT_BATCH, &moved);
+        if (n == 0) break;
         
+        size_t stale = 0;
         {
-            std::unique_lock lock(fight_mutex);
-            fight_cv.wait(lock, [this]() {
-                return !fight_queue.empty() || stop_requested;
-            });
-            
-            if (stop_requested) break;
-            
-            if (!fight_queue.empty()) {
-                fight_pair = fight_queue.front();
-                fight_queue.pop();
+            std::shared_lock lock(npcs_mutex);
+            size_t kept = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const NPC& a = *batch[i].first;
+                const NPC& b = *batch[i].second;
+                if (moved[i] && std::hypot(a.getX() - b.getX(), a.getY() - b.getY()) > KILL_DISTANCE) {
+                    ++stale;
+                    continue;
+                }
+                if (kept != i) batch[kept] = std::move(batch[i]);
+                ++kept;
             }
+            n = kept;
+            batch.resize(n);
         }
         
-        if (fight_pair.first && fight_pair.second) {
-            processFight(fight_pair.first, fight_pair.second);
+        attack_rolls.resize(n);
+        defense_rolls.resize(n);
+        outcomes.resize(n);
+        
+        rollDiceBatch(seed, counter, n, attack_rolls.data());
+        rollDiceBatch(seed, counter + n, n, defense_rolls.data());
+        counter += 2 * n;
+        duelBatch(attack_rolls.data(), defense_rolls.data(), n, outcomes.data());
+        
+        for (size_t i = 0; i < n; ++i) {
+            if (!processFight(batch[i].first, batch[i].second, attack_rolls[i], defense_rolls[i], outcomes[i])) {
+                ++stale;
+            }
         }
+        if (stale) fight_queue.reportStale(stale);
     }
     
-    {
-        std::lock_guard lock(cout_mutex);
-        std::cout << "Остановлен поток боев" << std::endl;
-    }
+    logDebug("Остановлен поток боев");
 }
 
 void Game::printMap() {
-    std::lock_guard lock(cout_mutex);
+    auto console = Logger::console();
     
 #ifdef _WIN32
     system("cls");
@@ -200,24 +270,29 @@ void Game::printMap() {
     std::cout << "ЛАБОРАТОРНАЯ 7" << std::endl;
     std::cout << "Вариант: Эльф (ход=" << ELF_MOVE_DISTANCE << ", бой=" << KILL_DISTANCE << ")" << std::endl;
     
-    std::shared_lock lock2(npcs_mutex);
-    int alive = npcs.size();
-    int dead = dead_npcs.size();
-    
-    std::cout << "Живые: " << alive << "  Мертвые: " << dead << std::endl;
+    std::cout << "Живые: " << stats.totalAlive() << "  Мертвые: " << stats.totalDead() << std::endl;
+    std::cout << "Очередь боев: " << fight_queue.size() << std::endl;
     std::cout << "Карта: " << MAP_WIDTH << "x" << MAP_HEIGHT << std::endl;
     
-    int bears = 0, elves = 0, robbers = 0;
-    for (const auto& npc : npcs) {
-        if (npc->type() == "Bear") bears++;
-        else if (npc->type() == "Elf") elves++;
-        else if (npc->type() == "Robber") robbers++;
+    std::cout << "Медведи: " << stats.aliveCount(Kind::Bear)
+              << " Эльфы: " << stats.aliveCount(Kind::Elf)
+              << " Разбойники: " << stats.aliveCount(Kind::Robber) << std::endl;
+    
+    std::cout << "Сильнейшие:";
+    for (const auto& e : stats.topStrongest(LEADERBOARD_SIZE)) {
+        std::cout << " " << e.name << "(" << e.value << ")";
     }
+    std::cout << std::endl;
     
-    std::cout << "Медведи: " << bears << " Эльфы: " << elves << " Разбойники: " << robbers << std::endl;
+    std::cout << "Опаснейшие:";
+    for (const auto& e : stats.topLethal(LEADERBOARD_SIZE)) {
+        std::cout << " " << e.name << "(" << e.value << ")";
+    }
+    std::cout << std::endl;
     
-    const int grid_size = 10;
+    const int grid_size = WorldStats::HEAT_CELLS;
     char grid[grid_size][grid_size];
+    int best[grid_size][grid_size] = {};
     
     for (int i = 0; i < grid_size; ++i) {
         for (int j = 0; j < grid_size; ++j) {
@@ -225,19 +300,16 @@ void Game::printMap() {
         }
     }
     
-    for (const auto& npc : npcs) {
-        int grid_x = (npc->getX() * grid_size) / MAP_WIDTH;
-        int grid_y = (npc->getY() * grid_size) / MAP_HEIGHT;
-        
-        grid_x = std::clamp(grid_x, 0, grid_size - 1);
-        grid_y = std::clamp(grid_y, 0, grid_size - 1);
-        
-        char symbol = '?';
-        if (npc->type() == "Bear") symbol = 'B';
-        else if (npc->type() == "Elf") symbol = 'E';
-        else if (npc->type() == "Robber") symbol = 'R';
-        
-        grid[grid_y][grid_x] = symbol;
+    for (Kind k : {Kind::Bear, Kind::Elf, Kind::Robber}) {
+        auto heat = stats.heatmap(k);
+        for (int y = 0; y < grid_size; ++y) {
+            for (int x = 0; x < grid_size; ++x) {
+                if (heat[y][x] > best[y][x]) {
+                    best[y][x] = heat[y][x];
+                    grid[y][x] = kindName(k)[0];
+                }
+            }
+        }
     }
     
     std::cout << "\nКарта (10x10):" << std::endl;
@@ -259,11 +331,8 @@ void Game::printMap() {
 void Game::run() {
     running = true;
     
-    {
-        std::lock_guard lock(cout_mutex);
-        std::cout << "\nНачало игры" << std::endl;
-        std::cout << "Длительность: " << GAME_DURATION << " секунд" << std::endl;
-    }
+    logInfo("\nНачало игры");
+    logInfo("Длительность: {} секунд", GAME_DURATION);
     
     movement_thread = std::thread(&Game::movementWorker, this);
     fight_thread = std::thread(&Game::fightWorker, this);
@@ -271,12 +340,16 @@ void Game::run() {
     auto start_time = std::chrono::steady_clock::now();
     
     for (int i = 0; i < GAME_DURATION && running; ++i) {
+        if (reinforcement_interval > 0 && i > 0 && i % reinforcement_interval == 0) {
+            PlacementStrategy placement;
+            placement.kind = Placement::Clustered;
+            placement.clusters = 1;
+            spawnWave(REINFORCEMENT_SIZE, placement);
+        }
+        
         printMap();
         
-        {
-            std::lock_guard lock(cout_mutex);
-            std::cout << "\nОсталось: " << (GAME_DURATION - i) << " секунд" << std::endl;
-        }
+        logInfo("\nОсталось: {} секунд", GAME_DURATION - i);
         
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
@@ -285,12 +358,23 @@ void Game::run() {
     
     {
         std::shared_lock lock(npcs_mutex);
-        std::lock_guard cout_lock(cout_mutex);
+        auto console = Logger::console();
         
         std::cout << "\nИГРА ЗАВЕРШЕНА" << std::endl;
         std::cout << "Выжившие: " << npcs.size() << std::endl;
         std::cout << "Погибшие: " << dead_npcs.size() << std::endl;
         
+        FightQueueStats q = fight_queue.stats();
+        std::cout << "Бои: обработано " << q.processed << ", дубликатов " << q.duplicates
+                  << ", устаревших " << q.stale << ", переполнение " << q.overflow
+                  << ", макс. очередь " << q.max_depth << std::endl;
+        if (journal.isOpen()) {
+            std::cout << "Журнал: " << journal.recordCount() << " записей в " << journal.filename() << std::endl;
+        }
+        if (uint64_t lost = Logger::dropped()) {
+            std::cout << "Лог: потеряно " << lost << " записей" << std::endl;
+        }
+        
         for (const auto& npc : npcs) {
             std::cout << npc->getName() << " (" << npc->type() << ") "
                       << "[" << npc->getX() << "," << npc->getY() << "]" << std::endl;
@@ -300,11 +384,13 @@ void Game::run() {
 
 void Game::stop() {
     stop_requested = true;
-    fight_cv.notify_all();
+    fight_queue.close();
     
     if (movement_thread.joinable()) movement_thread.join();
     if (fight_thread.joinable()) fight_thread.join();
     
+    journal.flush();
+    
     running = false;
 }
 
@@ -314,10 +400,17 @@ std::vector<std::shared_ptr<NPC>> Game::getSurvivors() const {
 }
 
 int Game::getAliveCount() const {
-    std::shared_lock lock(npcs_mutex);
-    return npcs.size();
+    return stats.totalAlive();
+}
+
+FightQueueStats Game::getFightQueueStats() const {
+    return fight_queue.stats();
 }
 
 int Game::getDeadCount() const {
-    return dead_npcs.size();
+    return stats.totalDead();
+}
+
+const WorldStats& Game::getStats() const {
+    return stats;
 }
\ No newline at end of file
@@ -5,9 +5,15 @@
 #include <mutex>
 #include <shared_mutex>
 #include <atomic>
-#include <queue>
-#include <condition_variable>
 #include <string>
+#include "../factory/factory.h"
+#include "../collision/collision.h"
+#include "../fightqueue/fightqueue.h"
+#include "../ai/ai.h"
+#include "../stats/stats.h"
+#include "../journal/journal.h"
+#include "../shm/shm.h"
+#include "../log/log.h"
 
 class NPC;
 
@@ -20,11 +26,16 @@ private:
     std::thread fight_thread;
     
     mutable std::shared_mutex npcs_mutex;
-    mutable std::mutex cout_mutex;
     
-    std::queue<std::pair<std::shared_ptr<NPC>, std::shared_ptr<NPC>>> fight_queue;
-    std::mutex fight_mutex;
-    std::condition_variable fight_cv;
+    FightQueue fight_queue;
+    
+    ContactTracker contacts;
+    std::mutex contacts_mutex;
+    
+    BehaviourScheduler behaviours;
+    WorldStats stats;
+    JournalWriter journal;
+    WorldPublisher publisher;
     
     std::atomic<bool> running;
     std::atomic<bool> stop_requested;
@@ -33,21 +44,42 @@ private:
     static constexpr int MAP_HEIGHT = 100;
     static constexpr int ELF_MOVE_DISTANCE = 10;  
     static constexpr int KILL_DISTANCE = 1;   
+    static constexpr int MOVE_DISTANCE = 5;
+    static constexpr uint32_t MOVE_CHANCE = 30;
+    static constexpr int AI_CELL_SIZE = 10;
+    static constexpr size_t LEADERBOARD_SIZE = 3;
+    static constexpr uint32_t KEYFRAME_INTERVAL = 25;
+    static constexpr size_t FIGHT_BATCH = 256;
+    static constexpr const char* SHM_NAME = "/oop_laba7_world";
+    static constexpr uint32_t SHM_CAPACITY = 4096;
     static constexpr int GAME_DURATION = 30;
+    static constexpr size_t INITIAL_NPC_COUNT = 50;
+    static constexpr size_t REINFORCEMENT_SIZE = 10;
+    
+    std::atomic<size_t> next_npc_index;
+    int reinforcement_interval;
     
+    SpawnConfig makeSpawnConfig(size_t count);
     void initializeNPCs();
+    void registerBehaviour(const std::shared_ptr<NPC>& npc);
     void movementWorker();
     void fightWorker();
     void printMap();
-    void processFight(std::shared_ptr<NPC> attacker, std::shared_ptr<NPC> defender);
+    bool processFight(std::shared_ptr<NPC> attacker, std::shared_ptr<NPC> defender,
+                      int attack_power, int defense_power, uint8_t outcome);
     
 public:
-    Game();
+    explicit Game(const std::string& journal_file = defaultJournalFile());
     ~Game();
     
     void run();
     void stop();
+    void spawnWave(size_t count, const PlacementStrategy& placement = {});
+    void setReinforcementInterval(int seconds);
+    static std::string defaultJournalFile();
     std::vector<std::shared_ptr<NPC>> getSurvivors() const;
     int getAliveCount() const;
     int getDeadCount() const;
+    FightQueueStats getFightQueueStats() const;
+    const WorldStats& getStats() const;
 };
\ No newline at end of file
@@ -0,0 +1,313 @@
+#include "journal.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+
+static_assert(std::endian::native == std::endian::little, "Журнал пишется в little-endian");
+
+namespace {
+
+constexpr char MAGIC[4] = {'N', 'P', 'C', 'J'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t HEADER_SIZE = sizeof(MAGIC) + sizeof(VERSION);
+constexpr size_t STATE_FIXED = 8 + 1 + 2 + 2 + 4 + 4 + 2;
+
+template <class T>
+void put(std::vector<uint8_t>& out, T value) {
+    uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <class T>
+T get(const std::vector<uint8_t>& in, size_t& offset) {
+    T value;
+    std::memcpy(&value, in.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return value;
+}
+
+uint64_t readState(const std::vector<uint8_t>& in, size_t& offset, ReplayNPC& npc) {
+    uint64_t id = get<uint64_t>(in, offset);
+    npc.kind = static_cast<Kind>(get<uint8_t>(in, offset));
+    npc.x = get<uint16_t>(in, offset);
+    npc.y = get<uint16_t>(in, offset);
+    npc.attack = get<int32_t>(in, offset);
+    npc.defense = get<int32_t>(in, offset);
+    uint16_t len = get<uint16_t>(in, offset);
+    npc.name.assign(reinterpret_cast<const char*>(in.data() + offset), len);
+    offset += len;
+    return id;
+}
+
+}
+
+JournalWriter::JournalWriter(const std::string& filename, size_t flush_bytes)
+    : path(filename), flush_threshold(flush_bytes), records(0), fights(0)
+{
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec) && !ec) f.open(path, std::ios::binary);
+    
+    buffer.reserve(flush_threshold + 1024);
+    buffer.resize(HEADER_SIZE);
+    std::memcpy(buffer.data(), MAGIC, sizeof(MAGIC));
+    std::memcpy(buffer.data() + sizeof(MAGIC), &VERSION, sizeof(VERSION));
+}
+
+JournalWriter::~JournalWriter() {
+    flush();
+}
+
+void JournalWriter::writeBuffer() {
+    if (f.is_open() && !buffer.empty()) {
+        f.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    }
+    buffer.clear();
+}
+
+void JournalWriter::commit() {
+    ++records;
+    if (buffer.size() >= flush_threshold) writeBuffer();
+}
+
+void JournalWriter::putState(const NPC& npc) {
+    const std::string& name = npc.getName();
+    uint16_t len = static_cast<uint16_t>(std::min<size_t>(name.size(), UINT16_MAX));
+    
+    put<uint64_t>(buffer, npc.getId());
+    put<uint8_t>(buffer, static_cast<uint8_t>(npc.getKind()));
+    put<uint16_t>(buffer, static_cast<uint16_t>(npc.getX()));
+    put<uint16_t>(buffer, static_cast<uint16_t>(npc.getY()));
+    put<int32_t>(buffer, npc.getAttack());
+    put<int32_t>(buffer, npc.getDefense());
+    put<uint16_t>(buffer, len);
+    buffer.insert(buffer.end(), name.begin(), name.begin() + len);
+}
+
+void JournalWriter::tick(uint32_t tick) {
+    std::lock_guard lock(m);
+    put(buffer, JournalRecord::Tick);
+    put<uint32_t>(buffer, tick);
+    commit();
+}
+
+void JournalWriter::spawn(const NPC& npc) {
+    std::lock_guard lock(m);
+    put(buffer, JournalRecord::Spawn);
+    putState(npc);
+    commit();
+}
+
+void JournalWriter::move(const NPC& npc) {
+    std::lock_guard lock(m);
+    put(buffer, JournalRecord::Move);
+    put<uint64_t>(buffer, npc.getId());
+    put<uint16_t>(buffer, static_cast<uint16_t>(npc.getX()));
+    put<uint16_t>(buffer, static_cast<uint16_t>(npc.getY()));
+    commit();
+}
+
+void JournalWriter::fight(const NPC& a, const NPC& b, FightOutcome outcome) {
+    std::lock_guard lock(m);
+    put(buffer, JournalRecord::Fight);
+    put<uint64_t>(buffer, a.getId());
+    put<uint64_t>(buffer, b.getId());
+    put(buffer, outcome);
+    ++fights;
+    commit();
+}
+
+void JournalWriter::death(const NPC& npc) {
+    std::lock_guard lock(m);
+    put(buffer, JournalRecord::Death);
+    put<uint64_t>(buffer, npc.getId());
+    commit();
+}
+
+void JournalWriter::power(const NPC& npc) {
+    std::lock_guard lock(m);
+    put(buffer, JournalRecord::Power);
+    put<uint64_t>(buffer, npc.getId());
+    put<int32_t>(buffer, npc.getAttack());
+    put<int32_t>(buffer, npc.getDefense());
+    commit();
+}
+
+void JournalWriter::keyframe(uint32_t tick, const std::vector<std::shared_ptr<NPC>>& npcs) {
+    std::lock_guard lock(m);
+    put(buffer, JournalRecord::Keyframe);
+    put<uint32_t>(buffer, tick);
+    put<uint64_t>(buffer, fights);
+    put<uint32_t>(buffer, static_cast<uint32_t>(npcs.size()));
+    for (const auto& npc : npcs) putState(*npc);
+    ++records;
+    writeBuffer();
+}
+
+void JournalWriter::flush() {
+    std::lock_guard lock(m);
+    writeBuffer();
+    if (f.is_open()) f.flush();
+}
+
+uint64_t JournalWriter::recordCount() const {
+    std::lock_guard lock(m);
+    return records;
+}
+
+JournalReader::JournalReader(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in.is_open()) return;
+    
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if (data.size() < HEADER_SIZE || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        data.clear();
+        return;
+    }
+    size_t version_offset = sizeof(MAGIC);
+    if (get<uint32_t>(data, version_offset) != VERSION) {
+        data.clear();
+        return;
+    }
+    
+    size_t offset = HEADER_SIZE;
+    while (offset < data.size()) {
+        size_t end = recordEnd(offset);
+        if (end == 0) break;
+        
+        auto type = static_cast<JournalRecord>(data[offset]);
+        if (type == JournalRecord::Tick || type == JournalRecord::Keyframe) {
+            size_t tick_offset = offset + 1;
+            uint32_t tick = get<uint32_t>(data, tick_offset);
+            (type == JournalRecord::Tick ? ticks : keyframes).emplace_back(tick, offset);
+        }
+        offset = end;
+    }
+    data.resize(offset);
+}
+
+size_t JournalReader::recordEnd(size_t offset) const {
+    auto fits = [this](size_t end) { return end <= data.size() ? end : 0; };
+    auto stateEnd = [&](size_t at) -> size_t {
+        if (!fits(at + STATE_FIXED)) return 0;
+        size_t len_offset = at + STATE_FIXED - 2;
+        return fits(at + STATE_FIXED + get<uint16_t>(data, len_offset));
+    };
+    
+    size_t body = offset + 1;
+    switch (static_cast<JournalRecord>(data[offset])) {
+        case JournalRecord::Tick: return fits(body + 4);
+        case JournalRecord::Spawn: return stateEnd(body);
+        case JournalRecord::Move: return fits(body + 12);
+        case JournalRecord::Fight: return fits(body + 17);
+        case JournalRecord::Death: return fits(body + 8);
+        case JournalRecord::Power: return fits(body + 16);
+        case JournalRecord::Keyframe: {
+            if (!fits(body + 16)) return 0;
+            size_t count_offset = body + 12;
+            uint32_t count = get<uint32_t>(data, count_offset);
+            size_t at = body + 16;
+            for (uint32_t i = 0; i < count && at; ++i) at = stateEnd(at);
+            return at;
+        }
+    }
+    return 0;
+}
+
+size_t JournalReader::apply(size_t offset, ReplayState& state) const {
+    auto type = static_cast<JournalRecord>(data[offset++]);
+    
+    switch (type) {
+        case JournalRecord::Tick:
+            state.tick = get<uint32_t>(data, offset);
+            break;
+        case JournalRecord::Spawn: {
+            ReplayNPC npc;
+            uint64_t id = readState(data, offset, npc);
+            state.npcs[id] = std::move(npc);
+            break;
+        }
+        case JournalRecord::Move: {
+            uint64_t id = get<uint64_t>(data, offset);
+            int x = get<uint16_t>(data, offset);
+            int y = get<uint16_t>(data, offset);
+            auto it = state.npcs.find(id);
+            if (it != state.npcs.end()) {
+                it->second.x = x;
+                it->second.y = y;
+            }
+            break;
+        }
+        case JournalRecord::Fight:
+            offset += 17;
+            ++state.fights;
+            break;
+        case JournalRecord::Death:
+            state.npcs.erase(get<uint64_t>(data, offset));
+            break;
+        case JournalRecord::Power: {
+            uint64_t id = get<uint64_t>(data, offset);
+            int attack = get<int32_t>(data, offset);
+            int defense = get<int32_t>(data, offset);
+            auto it = state.npcs.find(id);
+            if (it != state.npcs.end()) {
+                it->second.attack = attack;
+                it->second.defense = defense;
+            }
+            break;
+        }
+        case JournalRecord::Keyframe: {
+            state.tick = get<uint32_t>(data, offset);
+            state.fights = get<uint64_t>(data, offset);
+            uint32_t count = get<uint32_t>(data, offset);
+            state.npcs.clear();
+            state.npcs.reserve(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                ReplayNPC npc;
+                uint64_t id = readState(data, offset, npc);
+                state.npcs.emplace(id, std::move(npc));
+            }
+            break;
+        }
+    }
+    return offset;
+}
+
+size_t JournalReader::seekTo(uint32_t tick, ReplayState& state) const {
+    auto byTick = [](uint32_t t, const std::pair<uint32_t, size_t>& e) { return t < e.first; };
+    
+    size_t start = HEADER_SIZE;
+    auto kf = std::upper_bound(keyframes.begin(), keyframes.end(), tick, byTick);
+    if (kf != keyframes.begin()) start = std::prev(kf)->second;
+    
+    auto next = std::upper_bound(ticks.begin(), ticks.end(), tick, byTick);
+    size_t stop = next == ticks.end() ? data.size() : next->second;
+    
+    size_t offset = start;
+    while (offset < stop) offset = apply(offset, state);
+    return offset;
+}
+
+ReplayState JournalReader::seek(uint32_t tick) const {
+    ReplayState state;
+    if (valid()) seekTo(tick, state);
+    return state;
+}
+
+void JournalReader::replay(uint32_t from, uint32_t to, const std::function<void(const ReplayState&)>& onTick) const {
+    if (!valid()) return;
+    
+    ReplayState state;
+    seekTo(from, state);
+    onTick(state);
+    
+    auto byTick = [](uint32_t t, const std::pair<uint32_t, size_t>& e) { return t < e.first; };
+    for (auto it = std::upper_bound(ticks.begin(), ticks.end(), from, byTick);
+         it != ticks.end() && it->first <= to; ++it) {
+        size_t end = std::next(it) == ticks.end() ? data.size() : std::next(it)->second;
+        for (size_t offset = it->second; offset < end;) offset = apply(offset, state);
+        onTick(state);
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+#include "../npc.h"
+
+enum class JournalRecord : uint8_t {
+    Tick = 1,
+    Spawn = 2,
+    Move = 3,
+    Fight = 4,
+    Death = 5,
+    Power = 6,
+    Keyframe = 7
+};
+
+enum class FightOutcome : uint8_t {
+    None = 0,
+    FirstWins = 1,
+    SecondWins = 2,
+    BothDie = 3
+};
+
+class JournalWriter {
+    std::string path;
+    std::ofstream f;
+    std::vector<uint8_t> buffer;
+    size_t flush_threshold;
+    uint64_t records;
+    uint64_t fights;
+    mutable std::mutex m;
+    
+    void writeBuffer();
+    void commit();
+    void putState(const NPC& npc);
+
+public:
+    explicit JournalWriter(const std::string& filename, size_t flush_bytes = 64 * 1024);
+    ~JournalWriter();
+    
+    bool isOpen() const { return f.is_open(); }
+    const std::string& filename() const { return path; }
+    
+    void tick(uint32_t tick);
+    void spawn(const NPC& npc);
+    void move(const NPC& npc);
+    void fight(const NPC& a, const NPC& b, FightOutcome outcome);
+    void death(const NPC& npc);
+    void power(const NPC& npc);
+    void keyframe(uint32_t tick, const std::vector<std::shared_ptr<NPC>>& npcs);
+    void flush();
+    
+    uint64_t recordCount() const;
+};
+
+struct ReplayNPC {
+    std::string name;
+    Kind kind;
+    int x, y;
+    int attack, defense;
+};
+
+struct ReplayState {
+    uint32_t tick = 0;
+    uint64_t fights = 0;
+    std::unordered_map<uint64_t, ReplayNPC> npcs;
+};
+
+class JournalReader {
+    std::vector<uint8_t> data;
+    std::vector<std::pair<uint32_t, size_t>> keyframes;
+    std::vector<std::pair<uint32_t, size_t>> ticks;
+    
+    size_t apply(size_t offset, ReplayState& state) const;
+    size_t recordEnd(size_t offset) const;
+    size_t seekTo(uint32_t tick, ReplayState& state) const;
+
+public:
+    explicit JournalReader(const std::string& filename);
+    
+    bool valid() const { return !data.empty(); }
+    uint32_t lastTick() const { return ticks.empty() ? 0 : ticks.back().first; }
+    size_t keyframeCount() const { return keyframes.size(); }
+    
+    ReplayState seek(uint32_t tick) const;
+    void replay(uint32_t from, uint32_t to, const std::function<void(const ReplayState&)>& onTick) const;
+};
@@ -0,0 +1,248 @@
+#include "log.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using log_detail::Record;
+using log_detail::Ring;
+
+constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(20);
+
+class Backend {
+public:
+    std::atomic<uint64_t> dropped{0};
+
+private:
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::mutex rings_mutex;
+
+    std::mutex m;
+    std::condition_variable cv;
+    std::condition_variable flushed_cv;
+    uint64_t flush_requested = 0;
+    uint64_t flush_done = 0;
+    bool stopping = false;
+
+    std::mutex console_mutex;
+    std::vector<Record> batch;
+    std::string out;
+    std::thread worker;
+
+    void collect();
+    void format(const Record& r);
+    void drain();
+    void loop();
+
+public:
+    Backend() : worker(&Backend::loop, this) {}
+    ~Backend();
+
+    Ring* attach();
+    void flush();
+    std::mutex& consoleMutex() { return console_mutex; }
+};
+
+Backend& backend() {
+    static Backend b;
+    return b;
+}
+
+struct RingHolder {
+    Ring* ring = nullptr;
+
+    ~RingHolder() {
+        if (ring) ring->retired.store(true, std::memory_order_release);
+    }
+};
+
+thread_local RingHolder holder;
+
+Backend::~Backend() {
+    {
+        std::lock_guard lock(m);
+        stopping = true;
+    }
+    cv.notify_one();
+    worker.join();
+}
+
+Ring* Backend::attach() {
+    auto ring = std::make_unique<Ring>();
+    Ring* p = ring.get();
+    std::lock_guard lock(rings_mutex);
+    rings.push_back(std::move(ring));
+    return p;
+}
+
+void Backend::collect() {
+    std::lock_guard lock(rings_mutex);
+
+    for (auto& ring : rings) {
+        uint64_t h = ring->head.load(std::memory_order_relaxed);
+        uint64_t t = ring->tail.load(std::memory_order_acquire);
+        for (; h != t; ++h) {
+            batch.push_back(ring->slots[h % log_detail::RING_SLOTS]);
+        }
+        ring->head.store(h, std::memory_order_release);
+    }
+
+    rings.erase(std::remove_if(rings.begin(), rings.end(), [](const std::unique_ptr<Ring>& r) {
+        return r->retired.load(std::memory_order_acquire) &&
+               r->head.load(std::memory_order_relaxed) == r->tail.load(std::memory_order_acquire);
+    }), rings.end());
+}
+
+void Backend::format(const Record& r) {
+    if (r.tag) out += r.tag;
+
+    const uint8_t* p = r.data;
+    uint8_t left = r.argc;
+    char num[32];
+
+    for (const char* f = r.format; *f; ++f) {
+        if (f[0] != '{' || f[1] != '}') {
+            out += *f;
+            continue;
+        }
+        ++f;
+        if (left == 0) continue;
+        --left;
+
+        uint8_t tag = *p++;
+        switch (tag) {
+            case log_detail::Signed: {
+                int64_t v;
+                std::memcpy(&v, p, 8);
+                p += 8;
+                out.append(num, std::to_chars(num, num + sizeof(num), v).ptr);
+                break;
+            }
+            case log_detail::Unsigned: {
+                uint64_t v;
+                std::memcpy(&v, p, 8);
+                p += 8;
+                out.append(num, std::to_chars(num, num + sizeof(num), v).ptr);
+                break;
+            }
+            case log_detail::Float: {
+                double v;
+                std::memcpy(&v, p, 8);
+                p += 8;
+                out.append(num, std::to_chars(num, num + sizeof(num), v).ptr);
+                break;
+            }
+            case log_detail::Bool:
+                out += *p++ ? "true" : "false";
+                break;
+            case log_detail::KindName: {
+                Kind k;
+                std::memcpy(&k, p++, 1);
+                out += kindName(k);
+                break;
+            }
+            case log_detail::String: {
+                uint16_t len;
+                std::memcpy(&len, p, 2);
+                out.append(reinterpret_cast<const char*>(p + 2), len);
+                p += 2 + len;
+                break;
+            }
+        }
+    }
+    out += '\n';
+}
+
+void Backend::drain() {
+    batch.clear();
+    collect();
+    if (batch.empty()) return;
+
+    std::stable_sort(batch.begin(), batch.end(), [](const Record& a, const Record& b) {
+        return a.stamp < b.stamp;
+    });
+
+    out.clear();
+    for (const Record& r : batch) format(r);
+
+    std::lock_guard lock(console_mutex);
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    std::fflush(stdout);
+}
+
+void Backend::loop() {
+    std::unique_lock lock(m);
+
+    while (true) {
+        cv.wait_for(lock, DRAIN_INTERVAL, [this]() { return stopping || flush_requested != flush_done; });
+        bool stop = stopping;
+        uint64_t target = flush_requested;
+
+        lock.unlock();
+        drain();
+        lock.lock();
+
+        flush_done = target;
+        flushed_cv.notify_all();
+        if (stop) return;
+    }
+}
+
+void Backend::flush() {
+    std::unique_lock lock(m);
+    uint64_t ticket = ++flush_requested;
+    cv.notify_one();
+    flushed_cv.wait(lock, [&]() { return flush_done >= ticket; });
+}
+
+}
+
+void log_detail::placeholderCountMismatch() {}
+
+bool parseLogLevel(std::string_view name, LogLevel& out) {
+    static constexpr std::pair<std::string_view, LogLevel> names[] = {
+        {"debug", LogLevel::Debug}, {"info", LogLevel::Info}, {"warn", LogLevel::Warn},
+        {"error", LogLevel::Error}, {"off", LogLevel::Off}
+    };
+    for (const auto& [n, level] : names) {
+        if (n == name) {
+            out = level;
+            return true;
+        }
+    }
+    return false;
+}
+
+log_detail::Ring* Logger::threadRing() {
+    if (!holder.ring) holder.ring = backend().attach();
+    return holder.ring;
+}
+
+uint64_t Logger::now() {
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+void Logger::dropRecord() {
+    backend().dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Logger::flush() {
+    backend().flush();
+}
+
+std::unique_lock<std::mutex> Logger::console() {
+    Backend& b = backend();
+    b.flush();
+    return std::unique_lock(b.consoleMutex());
+}
+
+uint64_t Logger::dropped() {
+    return backend().dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,196 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <mutex>
+#include "../npc.h"
+
+enum class LogLevel : uint8_t {Debug, Info, Warn, Error, Off};
+
+bool parseLogLevel(std::string_view name, LogLevel& out);
+
+namespace log_detail {
+
+inline constexpr size_t RECORD_SIZE = 256;
+inline constexpr size_t RING_SLOTS = 4096;
+
+enum ArgTag : uint8_t {Signed, Unsigned, Float, Bool, String, KindName};
+
+template <class T>
+inline constexpr bool loggable = std::is_arithmetic_v<T> || std::is_same_v<T, Kind> ||
+                                 std::is_convertible_v<const T&, std::string_view>;
+
+void placeholderCountMismatch();
+
+consteval size_t countPlaceholders(const char* s) {
+    size_t n = 0;
+    for (; *s; ++s) {
+        if (s[0] == '{' && s[1] == '}') {
+            ++n;
+            ++s;
+        }
+    }
+    return n;
+}
+
+struct RecordHeader {
+    uint64_t stamp;
+    const char* format;
+    const char* tag;
+    LogLevel level;
+    uint8_t argc;
+    uint16_t used;
+    bool full;
+};
+
+struct Record : RecordHeader {
+    uint8_t data[RECORD_SIZE - sizeof(RecordHeader)];
+
+    void put(ArgTag t, const void* p, size_t n) {
+        data[used] = t;
+        std::memcpy(data + used + 1, p, n);
+        used += static_cast<uint16_t>(n + 1);
+        ++argc;
+    }
+
+    size_t room() const { return sizeof(data) - used; }
+
+    bool reserve(size_t n) {
+        if (!full && room() < n) full = true;
+        return !full;
+    }
+
+    template <class T>
+    void encode(const T& v) {
+        if constexpr (std::is_same_v<T, Kind>) {
+            if (!reserve(2)) return;
+            put(KindName, &v, 1);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            if (!reserve(2)) return;
+            uint8_t b = v;
+            put(Bool, &b, 1);
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            if (!reserve(9)) return;
+            int64_t x = v;
+            put(Signed, &x, 8);
+        } else if constexpr (std::is_integral_v<T>) {
+            if (!reserve(9)) return;
+            uint64_t x = v;
+            put(Unsigned, &x, 8);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            if (!reserve(9)) return;
+            double x = v;
+            put(Float, &x, 8);
+        } else {
+            std::string_view s(v);
+            if (!reserve(3)) return;
+            uint16_t len = static_cast<uint16_t>(std::min(s.size(), room() - 3));
+            data[used] = String;
+            std::memcpy(data + used + 1, &len, 2);
+            std::memcpy(data + used + 3, s.data(), len);
+            used += static_cast<uint16_t>(len + 3);
+            ++argc;
+        }
+    }
+};
+
+static_assert(sizeof(Record) == RECORD_SIZE);
+
+struct Ring {
+    Record slots[RING_SLOTS];
+    alignas(64) std::atomic<uint64_t> head{0};
+    alignas(64) std::atomic<uint64_t> tail{0};
+    uint64_t cached_head = 0;
+    std::atomic<bool> retired{false};
+
+    Record* claim() {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t - cached_head >= RING_SLOTS) {
+            cached_head = head.load(std::memory_order_acquire);
+            if (t - cached_head >= RING_SLOTS) return nullptr;
+        }
+        return &slots[t % RING_SLOTS];
+    }
+
+    void commit() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+};
+
+}
+
+template <class... A>
+struct LogFormat {
+    const char* str;
+
+    template <size_t N>
+    consteval LogFormat(const char (&s)[N]) : str(s) {
+        if (log_detail::countPlaceholders(s) != sizeof...(A)) log_detail::placeholderCountMismatch();
+    }
+};
+
+class Logger {
+    inline static std::atomic<LogLevel> threshold{LogLevel::Info};
+
+    static log_detail::Ring* threadRing();
+    static uint64_t now();
+    static void dropRecord();
+
+public:
+    static bool enabled(LogLevel level) {
+        return level >= threshold.load(std::memory_order_relaxed);
+    }
+
+    static void setLevel(LogLevel level) { threshold.store(level, std::memory_order_relaxed); }
+    static LogLevel level() { return threshold.load(std::memory_order_relaxed); }
+
+    template <class... A>
+    static void write(LogLevel level, const char* tag, LogFormat<std::type_identity_t<A>...> fmt, const A&... args) {
+        static_assert((log_detail::loggable<A> && ...), "Неподдерживаемый тип аргумента лога");
+        if (!enabled(level)) return;
+
+        log_detail::Ring* ring = threadRing();
+        log_detail::Record* r = ring->claim();
+        if (!r) {
+            dropRecord();
+            return;
+        }
+
+        r->stamp = now();
+        r->format = fmt.str;
+        r->tag = tag;
+        r->level = level;
+        r->argc = 0;
+        r->used = 0;
+        r->full = false;
+        (r->encode(args), ...);
+        ring->commit();
+    }
+
+    static void flush();
+    static std::unique_lock<std::mutex> console();
+    static uint64_t dropped();
+};
+
+template <class... A>
+void logDebug(LogFormat<std::type_identity_t<A>...> fmt, const A&... args) {
+    Logger::write(LogLevel::Debug, nullptr, fmt, args...);
+}
+
+template <class... A>
+void logInfo(LogFormat<std::type_identity_t<A>...> fmt, const A&... args) {
+    Logger::write(LogLevel::Info, nullptr, fmt, args...);
+}
+
+template <class... A>
+void logWarn(LogFormat<std::type_identity_t<A>...> fmt, const A&... args) {
+    Logger::write(LogLevel::Warn, nullptr, fmt, args...);
+}
+
+template <class... A>
+void logError(LogFormat<std::type_identity_t<A>...> fmt, const A&... args) {
+    Logger::write(LogLevel::Error, nullptr, fmt, args...);
+}
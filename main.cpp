@@ -1,12 +1,20 @@
 #include <iostream>
+#include <cstdlib>
 #include "game/game.h"
+#include "log/log.h"
 
 int main() {
     try {
+        if (const char* level = std::getenv("OOP_LABA7_LOG")) {
+            LogLevel parsed;
+            if (parseLogLevel(level, parsed)) Logger::setLevel(parsed);
+        }
+        
         std::cout << "ЛАБОРАТОРНАЯ РАБОТА №7" << std::endl;
         std::cout << "Вариант: Эльф (10/50)" << std::endl;
         
-        Game game;
+        const char* journal = std::getenv("OOP_LABA7_JOURNAL");
+        Game game(journal ? journal : Game::defaultJournalFile());
         
         game.run();
         
@@ -4,8 +4,25 @@
 #include <stdexcept>
 #include <algorithm>
 #include <cctype>
+#include <atomic>
+#include <cstdint>
 
-class FightVisitor;
+enum class Kind : uint8_t {
+    Bear,
+    Elf,
+    Robber
+};
+
+inline constexpr size_t KIND_COUNT = 3;
+
+inline const char* kindName(Kind k) {
+    switch (k) {
+        case Kind::Bear: return "Bear";
+        case Kind::Elf: return "Elf";
+        case Kind::Robber: return "Robber";
+    }
+    return "?";
+}
 
 class NPC {
 protected:
@@ -14,6 +31,16 @@ protected:
     int attack_power;
     int defense_power;
     
+    const Kind kind;
+    const uint64_t id;
+    std::atomic<bool> alive;
+    std::atomic<uint32_t> generation;
+    
+    static uint64_t nextId() {
+        static std::atomic<uint64_t> counter{1};
+        return counter.fetch_add(1, std::memory_order_relaxed);
+    }
+    
     void validateCoordinates(int xx, int yy) {
         if (xx <= 0 || xx > 500 || yy <= 0 || yy > 500) {
             throw std::invalid_argument("Координаты должны быть в диапазоне (0, 500]");
@@ -21,8 +48,9 @@ protected:
     }
     
 public:
-    NPC(std::string n, int xx, int yy, int attack, int defense) 
-        : name(n), x(xx), y(yy), attack_power(attack), defense_power(defense) {
+    NPC(Kind k, std::string n, int xx, int yy, int attack, int defense) 
+        : name(n), x(xx), y(yy), attack_power(attack), defense_power(defense),
+          kind(k), id(nextId()), alive(true), generation(0) {
         validateCoordinates(xx, yy);
     }
     
@@ -33,17 +61,28 @@ public:
     int getY() const { return y; }
     int getAttack() const { return attack_power; }
     int getDefense() const { return defense_power; }
+    Kind getKind() const { return kind; }
+    uint64_t getId() const { return id; }
+    bool isAlive() const { return alive.load(std::memory_order_acquire); }
+    uint32_t getGeneration() const { return generation.load(std::memory_order_acquire); }
+    
+    void markDead() {
+        generation.fetch_add(1, std::memory_order_acq_rel);
+        alive.store(false, std::memory_order_release);
+    }
     
     virtual void move(int dx, int dy) {
         validateCoordinates(x + dx, y + dy);
         x += dx;
         y += dy;
+        generation.fetch_add(1, std::memory_order_acq_rel);
     }
     
     void setPosition(int xx, int yy) {
         validateCoordinates(xx, yy);
         x = xx;
         y = yy;
+        generation.fetch_add(1, std::memory_order_acq_rel);
     }
     
     virtual void increasePower() {
@@ -52,7 +91,6 @@ public:
     }
     
     virtual std::string type() const = 0;
-    virtual void accept(FightVisitor& v) = 0;
     
     virtual std::string toString() const {
         std::string typeLower = type();
@@ -66,24 +104,27 @@ public:
 
 class Bear: public NPC {
 public:
+    static constexpr Kind KIND = Kind::Bear;
+    
     Bear(std::string n, int xx, int yy, int attack = 30, int defense = 40) 
-        : NPC(n, xx, yy, attack, defense) {}
+        : NPC(KIND, n, xx, yy, attack, defense) {}
     std::string type() const override;
-    void accept(FightVisitor& v) override;
 };
 
 class Elf: public NPC {
 public:
+    static constexpr Kind KIND = Kind::Elf;
+    
     Elf(std::string n, int xx, int yy, int attack = 25, int defense = 20) 
-        : NPC(n, xx, yy, attack, defense) {}
+        : NPC(KIND, n, xx, yy, attack, defense) {}
     std::string type() const override;
-    void accept(FightVisitor& v) override;
 };
 
 class Robber: public NPC {
 public:
+    static constexpr Kind KIND = Kind::Robber;
+    
     Robber(std::string n, int xx, int yy, int attack = 20, int defense = 15) 
-        : NPC(n, xx, yy, attack, defense) {}
+        : NPC(KIND, n, xx, yy, attack, defense) {}
     std::string type() const override;
-    void accept(FightVisitor& v) override;
 };
\ No newline at end of file
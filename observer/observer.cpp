@@ -1,23 +1,16 @@
 #include "observer.h"
+#include "../log/log.h"
 #include <chrono>
 #include <iomanip>
 
 ConsoleObserver console_obs;
 
 void ConsoleObserver::onKill(const std::string& killer, const std::string& victim) {
-    std::lock_guard<std::mutex> lock(cout_mutex);
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::cout << std::put_time(std::localtime(&time), "[%H:%M:%S] ")
-              << killer << " убил " << victim << std::endl;
+    logInfo("{} убил {}", killer, victim);
 }
 
 void ConsoleObserver::onDoubleDeath(const std::string& a, const std::string& b) {
-    std::lock_guard<std::mutex> lock(cout_mutex);
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::cout << std::put_time(std::localtime(&time), "[%H:%M:%S] ")
-              << a << " и " << b << " погибли вместе" << std::endl;
+    logInfo("{} и {} погибли вместе", a, b);
 }
 
 FileObserver::FileObserver() : f("log.txt", std::ios::app) {
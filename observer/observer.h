@@ -1,7 +1,6 @@
 #pragma once
 #include <string>
 #include <fstream>
-#include <iostream>
 #include <mutex>
 
 class IObserver {
@@ -12,7 +11,6 @@ public:
 };
 
 class ConsoleObserver : public IObserver {
-    mutable std::mutex cout_mutex;
 public:
     void onKill(const std::string& killer, const std::string& victim) override;
     void onDoubleDeath(const std::string& a, const std::string& b) override;
@@ -1,5 +1,3 @@
 #include "npc.h"
-#include "visitor/visitor.h"
 
-std::string Robber::type() const { return "Robber"; }
-void Robber::accept(FightVisitor& v) { v.visit(*this); }
\ No newline at end of file
+std::string Robber::type() const { return kindName(KIND); }
\ No newline at end of file
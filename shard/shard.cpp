@@ -0,0 +1,492 @@
+#include "shard.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cerrno>
+#include "../visitor/rules.h"
+
+namespace {
+
+constexpr size_t HEADER_SIZE = 5;
+
+void writeExact(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = ::send(fd, data, length, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Ошибка отправки в сокет шарда");
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+}
+
+void readExact(int fd, uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = ::recv(fd, data, length, 0);
+        if (n == 0) throw std::runtime_error("Соединение с шардом закрыто");
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Ошибка чтения из сокета шарда");
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+    }
+}
+
+std::vector<uint8_t> frame(ShardMessage type, const void* payload, size_t length) {
+    if (length > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Сообщение шарда слишком длинное");
+    }
+    std::vector<uint8_t> out(HEADER_SIZE + length);
+    uint32_t len = static_cast<uint32_t>(length);
+    out[0] = static_cast<uint8_t>(type);
+    std::memcpy(out.data() + 1, &len, sizeof(len));
+    if (length) std::memcpy(out.data() + HEADER_SIZE, payload, length);
+    return out;
+}
+
+std::vector<uint8_t> entityPayload(uint32_t tick, const std::vector<ShardEntity>& entities) {
+    std::vector<uint8_t> out(sizeof(tick) + entities.size() * sizeof(ShardEntity));
+    std::memcpy(out.data(), &tick, sizeof(tick));
+    if (!entities.empty()) {
+        std::memcpy(out.data() + sizeof(tick), entities.data(), entities.size() * sizeof(ShardEntity));
+    }
+    return out;
+}
+
+std::vector<ShardEntity> entitiesFrom(const uint8_t* data, size_t length) {
+    if (length % sizeof(ShardEntity) != 0) {
+        throw std::runtime_error("Некорректный размер списка NPC");
+    }
+    std::vector<ShardEntity> out(length / sizeof(ShardEntity));
+    if (!out.empty()) std::memcpy(out.data(), data, length);
+    return out;
+}
+
+struct Transfer {
+    int fd;
+    std::vector<uint8_t> out;
+    size_t sent = 0;
+    std::vector<uint8_t> in = std::vector<uint8_t>(HEADER_SIZE);
+    size_t received = 0;
+    bool header_done = false;
+    
+    bool sending() const { return sent < out.size(); }
+    bool receiving() const { return !header_done || received < in.size(); }
+};
+
+}
+
+int ShardConfig::ownerOf(int x) const {
+    return std::clamp((x - 1) * shards / width, 0, shards - 1);
+}
+
+int ShardConfig::left(int shard) const {
+    return shard > 0 ? shard - 1 : -1;
+}
+
+int ShardConfig::right(int shard) const {
+    return shard + 1 < shards ? shard + 1 : -1;
+}
+
+void Channel::send(ShardMessage type, const void* payload, size_t length) const {
+    auto out = frame(type, payload, length);
+    writeExact(fd, out.data(), out.size());
+}
+
+ShardMessage Channel::receive(std::vector<uint8_t>& payload) const {
+    uint8_t header[HEADER_SIZE];
+    readExact(fd, header, HEADER_SIZE);
+    
+    uint32_t len;
+    std::memcpy(&len, header + 1, sizeof(len));
+    payload.resize(len);
+    if (len) readExact(fd, payload.data(), len);
+    return static_cast<ShardMessage>(header[0]);
+}
+
+ShardWorker::ShardWorker(const ShardConfig& cfg, int shard, int coordinator_fd, int left_fd, int right_fd)
+    : config(cfg), index(shard), coordinator(coordinator_fd), left_link(left_fd), right_link(right_fd),
+      rng((cfg.seed + 1) * 0x9E3779B97F4A7C15ULL ^ static_cast<uint64_t>(shard + 1))
+{
+    if (rng == 0) rng = 1;
+}
+
+uint32_t ShardWorker::random() {
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return static_cast<uint32_t>((rng * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+void ShardWorker::moveAll() {
+    for (auto& e : owned) {
+        int distance;
+        if (static_cast<Kind>(e.kind) == Kind::Elf) {
+            distance = config.elf_move;
+        } else if (static_cast<int>(random() % 100) < config.move_chance) {
+            distance = config.move;
+        } else {
+            continue;
+        }
+        
+        int nx = e.x + (static_cast<int>(random() % 3) - 1) * distance;
+        int ny = e.y + (static_cast<int>(random() % 3) - 1) * distance;
+        if (nx >= 1 && nx <= config.width && ny >= 1 && ny <= config.height) {
+            e.x = nx;
+            e.y = ny;
+        }
+    }
+}
+
+std::pair<std::vector<ShardEntity>, std::vector<ShardEntity>> ShardWorker::split(bool migrate) {
+    std::vector<ShardEntity> to_left, to_right;
+    
+    if (migrate) {
+        auto keep = std::partition(owned.begin(), owned.end(), [this](const ShardEntity& e) {
+            return config.ownerOf(e.x) == index;
+        });
+        for (auto it = keep; it != owned.end(); ++it) {
+            (config.ownerOf(it->x) < index ? to_left : to_right).push_back(*it);
+        }
+        owned.erase(keep, owned.end());
+    } else {
+        int k = config.kill_distance;
+        for (const auto& e : owned) {
+            if (config.ownerOf(std::max(1, e.x - k)) < index) to_left.push_back(e);
+            if (config.ownerOf(std::min(config.width, e.x + k)) > index) to_right.push_back(e);
+        }
+    }
+    return {std::move(to_left), std::move(to_right)};
+}
+
+std::vector<ShardEntity> ShardWorker::exchange(ShardMessage type, uint32_t tick,
+                                               const std::vector<ShardEntity>& to_left,
+                                               const std::vector<ShardEntity>& to_right) {
+    std::vector<Transfer> transfers;
+    if (left_link.valid()) {
+        auto payload = entityPayload(tick, to_left);
+        transfers.push_back({left_link.descriptor(), frame(type, payload.data(), payload.size())});
+    }
+    if (right_link.valid()) {
+        auto payload = entityPayload(tick, to_right);
+        transfers.push_back({right_link.descriptor(), frame(type, payload.data(), payload.size())});
+    }
+    
+    std::vector<pollfd> fds(transfers.size());
+    while (std::any_of(transfers.begin(), transfers.end(),
+                       [](const Transfer& t) { return t.sending() || t.receiving(); })) {
+        for (size_t i = 0; i < transfers.size(); ++i) {
+            fds[i] = {transfers[i].fd, 0, 0};
+            if (transfers[i].sending()) fds[i].events |= POLLOUT;
+            if (transfers[i].receiving()) fds[i].events |= POLLIN;
+        }
+        
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Ошибка poll при обмене с соседним шардом");
+        }
+        
+        for (size_t i = 0; i < transfers.size(); ++i) {
+            Transfer& t = transfers[i];
+            
+            if ((fds[i].revents & POLLOUT) && t.sending()) {
+                ssize_t n = ::send(t.fd, t.out.data() + t.sent, t.out.size() - t.sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+                if (n > 0) t.sent += static_cast<size_t>(n);
+                else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    throw std::runtime_error("Ошибка отправки соседнему шарду");
+                }
+            }
+            
+            if ((fds[i].revents & (POLLIN | POLLHUP | POLLERR)) && t.receiving()) {
+                ssize_t n = ::recv(t.fd, t.in.data() + t.received, t.in.size() - t.received, MSG_DONTWAIT);
+                if (n == 0) throw std::runtime_error("Соседний шард закрыл соединение");
+                if (n < 0) {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                        throw std::runtime_error("Ошибка чтения от соседнего шарда");
+                    }
+                    continue;
+                }
+                t.received += static_cast<size_t>(n);
+                
+                if (!t.header_done && t.received == HEADER_SIZE) {
+                    if (static_cast<ShardMessage>(t.in[0]) != type) {
+                        throw std::runtime_error("Неожиданное сообщение от соседнего шарда");
+                    }
+                    uint32_t len;
+                    std::memcpy(&len, t.in.data() + 1, sizeof(len));
+                    t.in.resize(HEADER_SIZE + len);
+                    t.header_done = true;
+                }
+            }
+        }
+    }
+    
+    std::vector<ShardEntity> incoming;
+    for (const auto& t : transfers) {
+        const uint8_t* payload = t.in.data() + HEADER_SIZE;
+        size_t length = t.in.size() - HEADER_SIZE;
+        uint32_t their_tick;
+        if (length < sizeof(their_tick)) throw std::runtime_error("Пустое сообщение от соседнего шарда");
+        std::memcpy(&their_tick, payload, sizeof(their_tick));
+        if (their_tick != tick) throw std::runtime_error("Шарды рассинхронизированы по тикам");
+        
+        auto entities = entitiesFrom(payload + sizeof(their_tick), length - sizeof(their_tick));
+        incoming.insert(incoming.end(), entities.begin(), entities.end());
+    }
+    return incoming;
+}
+
+void ShardWorker::fight() {
+    const int k = config.kill_distance;
+    const int cell = std::max(1, k);
+    const size_t n = owned.size();
+    
+    auto at = [&](size_t i) -> const ShardEntity& { return i < n ? owned[i] : ghosts[i - n]; };
+    auto key = [](int cx, int cy) { return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy); };
+    
+    std::unordered_map<uint64_t, std::vector<uint32_t>> grid;
+    for (size_t i = 0; i < n + ghosts.size(); ++i) {
+        grid[key(at(i).x / cell, at(i).y / cell)].push_back(static_cast<uint32_t>(i));
+    }
+    
+    std::unordered_map<uint64_t, int> dead_ids;
+    std::unordered_map<uint64_t, int> kills;
+    
+    for (size_t i = 0; i < n; ++i) {
+        const ShardEntity& self = owned[i];
+        int cx = self.x / cell, cy = self.y / cell;
+        
+        for (int gx = cx - 1; gx <= cx + 1; ++gx) {
+            for (int gy = cy - 1; gy <= cy + 1; ++gy) {
+                auto bucket = grid.find(key(gx, gy));
+                if (bucket == grid.end()) continue;
+                
+                for (uint32_t j : bucket->second) {
+                    if (j == i) continue;
+                    const ShardEntity& other = at(j);
+                    bool ghost = j >= n;
+                    if (!ghost && other.id <= self.id) continue;
+                    if (std::hypot(self.x - other.x, self.y - other.y) > k) continue;
+                    
+                    const ShardEntity& a = self.id < other.id ? self : other;
+                    const ShardEntity& b = self.id < other.id ? other : self;
+                    auto [a_wins, b_wins] = resolveFight(static_cast<Kind>(a.kind), a.attack, a.defense,
+                                                         static_cast<Kind>(b.kind), b.attack, b.defense);
+                    
+                    if (!ghost || self.id < other.id) report.fights++;
+                    
+                    if (a_wins && !b_wins) {
+                        dead_ids[b.id] = 1;
+                        kills[a.id]++;
+                    } else if (!a_wins && b_wins) {
+                        dead_ids[a.id] = 1;
+                        kills[b.id]++;
+                    } else if (!a_wins && !b_wins) {
+                        dead_ids[a.id] = 1;
+                        dead_ids[b.id] = 1;
+                    }
+                }
+            }
+        }
+    }
+    
+    for (auto& e : owned) {
+        auto it = kills.find(e.id);
+        if (it != kills.end()) {
+            e.attack += 5 * it->second;
+            e.defense += 5 * it->second;
+        }
+    }
+    
+    auto alive_end = std::partition(owned.begin(), owned.end(), [&](const ShardEntity& e) {
+        return !dead_ids.count(e.id);
+    });
+    for (auto it = alive_end; it != owned.end(); ++it) {
+        report.dead[it->kind]++;
+    }
+    owned.erase(alive_end, owned.end());
+}
+
+void ShardWorker::step(uint32_t tick) {
+    report.tick = tick;
+    report.fights = 0;
+    
+    moveAll();
+    
+    auto [migrate_left, migrate_right] = split(true);
+    report.migrations = static_cast<uint32_t>(migrate_left.size() + migrate_right.size());
+    auto arrived = exchange(ShardMessage::Migrate, tick, migrate_left, migrate_right);
+    owned.insert(owned.end(), arrived.begin(), arrived.end());
+    
+    auto [halo_left, halo_right] = split(false);
+    ghosts = exchange(ShardMessage::Halo, tick, halo_left, halo_right);
+    
+    fight();
+    
+    std::fill(std::begin(report.alive), std::end(report.alive), 0);
+    for (const auto& e : owned) report.alive[e.kind]++;
+}
+
+void ShardWorker::run() {
+    std::vector<uint8_t> payload;
+    
+    while (true) {
+        switch (coordinator.receive(payload)) {
+            case ShardMessage::Spawn: {
+                auto spawned = entitiesFrom(payload.data(), payload.size());
+                owned.insert(owned.end(), spawned.begin(), spawned.end());
+                break;
+            }
+            case ShardMessage::Tick: {
+                uint32_t tick;
+                if (payload.size() != sizeof(tick)) throw std::runtime_error("Некорректное сообщение тика");
+                std::memcpy(&tick, payload.data(), sizeof(tick));
+                step(tick);
+                coordinator.send(ShardMessage::TickDone, &report, sizeof(report));
+                break;
+            }
+            case ShardMessage::Stop:
+                return;
+            default:
+                throw std::runtime_error("Неизвестное сообщение от координатора");
+        }
+    }
+}
+
+ShardCoordinator::ShardCoordinator(const ShardConfig& cfg)
+    : config(cfg), tick_count(0), next_id(1), gen(cfg.seed) {
+    if (config.shards < 1 || config.width < config.shards * std::max({config.elf_move, config.move, config.kill_distance})) {
+        throw std::invalid_argument("Полоса шарда должна быть не уже дальности хода и боя");
+    }
+}
+
+ShardCoordinator::~ShardCoordinator() {
+    try {
+        stop();
+    } catch (...) {
+    }
+}
+
+void ShardCoordinator::start() {
+    const int s = config.shards;
+    std::vector<int> to_close;
+    std::vector<std::array<int, 2>> coord(s), neighbours(s > 1 ? s - 1 : 0);
+    
+    for (auto& p : coord) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, p.data()) != 0) throw std::runtime_error("socketpair не удался");
+    }
+    for (auto& p : neighbours) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, p.data()) != 0) throw std::runtime_error("socketpair не удался");
+    }
+    
+    for (int i = 0; i < s; ++i) {
+        pid_t pid = fork();
+        if (pid < 0) throw std::runtime_error("fork не удался");
+        
+        if (pid == 0) {
+            int own = coord[i][1];
+            int left = i > 0 ? neighbours[i - 1][1] : -1;
+            int right = i + 1 < s ? neighbours[i][0] : -1;
+            
+            for (auto& p : coord) for (int fd : p) if (fd != own) ::close(fd);
+            for (auto& p : neighbours) for (int fd : p) if (fd != left && fd != right) ::close(fd);
+            
+            int code = 0;
+            try {
+                ShardWorker worker(config, i, own, left, right);
+                worker.run();
+            } catch (const std::exception&) {
+                code = 1;
+            }
+            _exit(code);
+        }
+        children.push_back(pid);
+    }
+    
+    for (auto& p : coord) {
+        ::close(p[1]);
+        links.emplace_back(p[0]);
+    }
+    for (auto& p : neighbours) {
+        ::close(p[0]);
+        ::close(p[1]);
+    }
+}
+
+void ShardCoordinator::spawn(size_t count) {
+    std::uniform_int_distribution<int> kind(0, static_cast<int>(KIND_COUNT) - 1);
+    std::uniform_int_distribution<int> x(1, config.width), y(1, config.height);
+    std::uniform_int_distribution<int> attack(15, 35), defense(10, 30);
+    
+    std::vector<std::vector<ShardEntity>> buckets(config.shards);
+    for (size_t i = 0; i < count; ++i) {
+        ShardEntity e{};
+        e.id = next_id++;
+        e.kind = static_cast<uint8_t>(kind(gen));
+        e.x = x(gen);
+        e.y = y(gen);
+        e.attack = attack(gen);
+        e.defense = defense(gen);
+        buckets[config.ownerOf(e.x)].push_back(e);
+    }
+    
+    for (int i = 0; i < config.shards; ++i) {
+        links[i].send(ShardMessage::Spawn, buckets[i].data(), buckets[i].size() * sizeof(ShardEntity));
+    }
+}
+
+ShardReport ShardCoordinator::tick() {
+    uint32_t tick = ++tick_count;
+    for (const auto& link : links) {
+        link.send(ShardMessage::Tick, &tick, sizeof(tick));
+    }
+    
+    ShardReport total;
+    total.tick = tick;
+    std::vector<uint8_t> payload;
+    
+    for (const auto& link : links) {
+        if (link.receive(payload) != ShardMessage::TickDone || payload.size() != sizeof(ShardReport)) {
+            throw std::runtime_error("Некорректный отчет шарда");
+        }
+        ShardReport r;
+        std::memcpy(&r, payload.data(), sizeof(r));
+        if (r.tick != tick) throw std::runtime_error("Шард ответил за другой тик");
+        
+        for (size_t k = 0; k < KIND_COUNT; ++k) {
+            total.alive[k] += r.alive[k];
+            total.dead[k] += r.dead[k];
+        }
+        total.fights += r.fights;
+        total.migrations += r.migrations;
+    }
+    return total;
+}
+
+void ShardCoordinator::stop() {
+    for (const auto& link : links) {
+        try {
+            link.send(ShardMessage::Stop, nullptr, 0);
+        } catch (const std::exception&) {
+        }
+        ::close(link.descriptor());
+    }
+    links.clear();
+    
+    for (pid_t pid : children) {
+        int status;
+        waitpid(pid, &status, 0);
+    }
+    children.clear();
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <random>
+#include <sys/types.h>
+#include "../npc.h"
+
+struct ShardEntity {
+    uint64_t id;
+    int32_t x, y;
+    int32_t attack, defense;
+    uint8_t kind;
+    uint8_t reserved[7];
+};
+
+enum class ShardMessage : uint8_t {
+    Spawn = 1,
+    Tick = 2,
+    Migrate = 3,
+    Halo = 4,
+    TickDone = 5,
+    Stop = 6
+};
+
+struct ShardReport {
+    uint32_t tick = 0;
+    int32_t alive[KIND_COUNT] = {};
+    int32_t dead[KIND_COUNT] = {};
+    uint32_t fights = 0;
+    uint32_t migrations = 0;
+};
+
+struct ShardConfig {
+    int shards = 4;
+    int width = 500;
+    int height = 500;
+    int kill_distance = 1;
+    int elf_move = 10;
+    int move = 5;
+    int move_chance = 30;
+    uint64_t seed = 1;
+    
+    int ownerOf(int x) const;
+    int left(int shard) const;
+    int right(int shard) const;
+};
+
+class Channel {
+    int fd;
+
+public:
+    explicit Channel(int descriptor = -1) : fd(descriptor) {}
+    
+    int descriptor() const { return fd; }
+    bool valid() const { return fd >= 0; }
+    
+    void send(ShardMessage type, const void* payload, size_t length) const;
+    ShardMessage receive(std::vector<uint8_t>& payload) const;
+};
+
+// Шардированный движок следует собственному набору правил, а не правилам Game:
+// движение - случайное блуждание без корутинного ИИ (ai/), бои - одновременные
+// и детерминированные по FightRule (visitor/rules.h), без бросков кубиков Game::processFight.
+// Поэтому результаты шардов не совпадают с одиночной игрой.
+class ShardWorker {
+    const ShardConfig& config;
+    int index;
+    int x0, x1;
+    Channel coordinator;
+    Channel left_link, right_link;
+    
+    std::vector<ShardEntity> owned;
+    std::vector<ShardEntity> ghosts;
+    uint64_t rng;
+    ShardReport report;
+    
+    uint32_t random();
+    void moveAll();
+    std::pair<std::vector<ShardEntity>, std::vector<ShardEntity>> split(bool migrate);
+    std::vector<ShardEntity> exchange(ShardMessage type, uint32_t tick,
+                                      const std::vector<ShardEntity>& to_left,
+                                      const std::vector<ShardEntity>& to_right);
+    void fight();
+    void step(uint32_t tick);
+
+public:
+    ShardWorker(const ShardConfig& cfg, int shard, int coordinator_fd, int left_fd, int right_fd);
+    void run();
+};
+
+class ShardCoordinator {
+    ShardConfig config;
+    std::vector<Channel> links;
+    std::vector<pid_t> children;
+    uint32_t tick_count;
+    uint64_t next_id;
+    std::mt19937_64 gen;
+    
+public:
+    explicit ShardCoordinator(const ShardConfig& cfg);
+    ~ShardCoordinator();
+    
+    void start();
+    void spawn(size_t count);
+    ShardReport tick();
+    void stop();
+};
@@ -0,0 +1,247 @@
+#include "shm.h"
+#include <algorithm>
+#include <new>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint32_t SHM_MAGIC = 0x574F524C;
+constexpr uint32_t SHM_VERSION = 1;
+constexpr size_t SHM_ALIGN = 64;
+
+constexpr size_t alignUp(size_t n) {
+    return (n + SHM_ALIGN - 1) / SHM_ALIGN * SHM_ALIGN;
+}
+
+constexpr size_t HEADER_BYTES = alignUp(sizeof(ShmHeader));
+constexpr size_t FRAME_HEADER_BYTES = alignUp(sizeof(ShmFrameHeader));
+
+const ShmEntity* entitiesOf(const ShmFrameHeader* slot) {
+    return reinterpret_cast<const ShmEntity*>(reinterpret_cast<const char*>(slot) + FRAME_HEADER_BYTES);
+}
+
+ShmEntity* entitiesOf(ShmFrameHeader* slot) {
+    return reinterpret_cast<ShmEntity*>(reinterpret_cast<char*>(slot) + FRAME_HEADER_BYTES);
+}
+
+}
+
+WorldPublisher::WorldPublisher() : device(0), inode(0), base(nullptr), size(0), header(nullptr), frame(0) {}
+
+WorldPublisher::~WorldPublisher() {
+    close();
+}
+
+ShmFrameHeader* WorldPublisher::slot(uint64_t n) const {
+    char* p = static_cast<char*>(base) + HEADER_BYTES + (n % header->slot_count) * header->slot_bytes;
+    return reinterpret_cast<ShmFrameHeader*>(p);
+}
+
+bool WorldPublisher::open(const std::string& shm_name, uint32_t capacity, uint32_t slots) {
+#ifdef _WIN32
+    (void)shm_name; (void)capacity; (void)slots;
+    return false;
+#else
+    close();
+    if (slots < 2 || capacity == 0) return false;
+    
+    size_t slot_bytes = alignUp(FRAME_HEADER_BYTES + static_cast<size_t>(capacity) * sizeof(ShmEntity));
+    size_t total = HEADER_BYTES + slots * slot_bytes;
+    
+    shm_unlink(shm_name.c_str());
+    int fd = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) return false;
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || ftruncate(fd, static_cast<off_t>(total)) != 0) {
+        ::close(fd);
+        shm_unlink(shm_name.c_str());
+        return false;
+    }
+    
+    void* p = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        shm_unlink(shm_name.c_str());
+        return false;
+    }
+    
+    name = shm_name;
+    device = static_cast<uint64_t>(st.st_dev);
+    inode = static_cast<uint64_t>(st.st_ino);
+    base = p;
+    size = total;
+    frame = 0;
+    
+    header = new (base) ShmHeader{};
+    header->version = SHM_VERSION;
+    header->slot_count = slots;
+    header->capacity = capacity;
+    header->slot_bytes = slot_bytes;
+    header->live.store(1, std::memory_order_relaxed);
+    header->latest.store(0, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < slots; ++i) {
+        new (slot(i)) ShmFrameHeader{};
+    }
+    
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = SHM_MAGIC;
+    return true;
+#endif
+}
+
+void WorldPublisher::close() {
+#ifndef _WIN32
+    if (!header) return;
+    header->live.store(0, std::memory_order_release);
+    munmap(base, size);
+    
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd >= 0) {
+        struct stat st;
+        bool ours = fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_dev) == device &&
+                    static_cast<uint64_t>(st.st_ino) == inode;
+        ::close(fd);
+        if (ours) shm_unlink(name.c_str());
+    }
+#endif
+    header = nullptr;
+    base = nullptr;
+    size = 0;
+}
+
+void WorldPublisher::publish(uint32_t tick, const std::vector<std::shared_ptr<NPC>>& npcs,
+                             const int (&alive)[KIND_COUNT], const int (&dead)[KIND_COUNT]) {
+    if (!header) return;
+    
+    uint64_t n = ++frame;
+    ShmFrameHeader* s = slot(n);
+    
+    uint64_t seq = s->seq.load(std::memory_order_relaxed);
+    s->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    uint32_t count = static_cast<uint32_t>(std::min<size_t>(npcs.size(), header->capacity));
+    s->frame = n;
+    s->tick = tick;
+    s->count = count;
+    s->truncated = npcs.size() > header->capacity;
+    std::copy(std::begin(alive), std::end(alive), s->alive);
+    std::copy(std::begin(dead), std::end(dead), s->dead);
+    
+    ShmEntity* out = entitiesOf(s);
+    for (uint32_t i = 0; i < count; ++i) {
+        const NPC& npc = *npcs[i];
+        out[i] = {npc.getId(), static_cast<uint16_t>(npc.getX()), static_cast<uint16_t>(npc.getY()),
+                  static_cast<uint8_t>(npc.getKind()), {}, npc.getAttack(), npc.getDefense()};
+    }
+    
+    s->seq.store(seq + 2, std::memory_order_release);
+    header->latest.store(n, std::memory_order_release);
+}
+
+WorldReader::WorldReader() : base(nullptr), size(0), header(nullptr) {}
+
+WorldReader::~WorldReader() {
+    close();
+}
+
+const ShmFrameHeader* WorldReader::slot(uint64_t n) const {
+    const char* p = static_cast<const char*>(base) + HEADER_BYTES + (n % header->slot_count) * header->slot_bytes;
+    return reinterpret_cast<const ShmFrameHeader*>(p);
+}
+
+bool WorldReader::open(const std::string& shm_name) {
+#ifdef _WIN32
+    (void)shm_name;
+    return false;
+#else
+    close();
+    
+    int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < HEADER_BYTES) {
+        ::close(fd);
+        return false;
+    }
+    
+    size_t total = static_cast<size_t>(st.st_size);
+    void* p = mmap(nullptr, total, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) return false;
+    
+    auto* h = static_cast<const ShmHeader*>(p);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (h->magic != SHM_MAGIC || h->version != SHM_VERSION || h->slot_count == 0 ||
+        h->slot_bytes > (total - HEADER_BYTES) / h->slot_count ||
+        FRAME_HEADER_BYTES + static_cast<uint64_t>(h->capacity) * sizeof(ShmEntity) > h->slot_bytes) {
+        munmap(p, total);
+        return false;
+    }
+    
+    base = p;
+    size = total;
+    header = h;
+    return true;
+#endif
+}
+
+void WorldReader::close() {
+#ifndef _WIN32
+    if (header) munmap(base, size);
+#endif
+    header = nullptr;
+    base = nullptr;
+    size = 0;
+}
+
+bool WorldReader::publisherLive() const {
+    return header && header->live.load(std::memory_order_acquire) != 0;
+}
+
+uint64_t WorldReader::latestFrame() const {
+    return header ? header->latest.load(std::memory_order_acquire) : 0;
+}
+
+uint64_t WorldReader::oldestFrame() const {
+    uint64_t latest = latestFrame();
+    if (!header || latest == 0) return 0;
+    return latest + 2 > header->slot_count ? latest + 2 - header->slot_count : 1;
+}
+
+bool WorldReader::read(uint64_t n, WorldFrame& out) const {
+    if (!header || n == 0 || n > latestFrame()) return false;
+    
+    const ShmFrameHeader* s = slot(n);
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        uint64_t before = s->seq.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        if (s->frame != n) return false;
+        
+        uint32_t count = std::min(s->count, header->capacity);
+        out.frame = s->frame;
+        out.tick = s->tick;
+        out.truncated = s->truncated != 0;
+        std::copy(std::begin(s->alive), std::end(s->alive), out.alive);
+        std::copy(std::begin(s->dead), std::end(s->dead), out.dead);
+        out.entities.assign(entitiesOf(s), entitiesOf(s) + count);
+        
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s->seq.load(std::memory_order_relaxed) == before && out.frame == n) return true;
+    }
+    return false;
+}
+
+bool WorldReader::readLatest(WorldFrame& out) const {
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        if (read(latestFrame(), out)) return true;
+    }
+    return false;
+}
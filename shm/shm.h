@@ -0,0 +1,96 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include "../npc.h"
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Нужны lock-free 64-битные атомики");
+
+struct ShmEntity {
+    uint64_t id;
+    uint16_t x, y;
+    uint8_t kind;
+    uint8_t reserved[3];
+    int32_t attack;
+    int32_t defense;
+};
+
+struct ShmFrameHeader {
+    std::atomic<uint64_t> seq;
+    uint64_t frame;
+    uint32_t tick;
+    uint32_t count;
+    uint32_t truncated;
+    int32_t alive[KIND_COUNT];
+    int32_t dead[KIND_COUNT];
+};
+
+struct ShmHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t capacity;
+    uint64_t slot_bytes;
+    std::atomic<uint32_t> live;
+    std::atomic<uint64_t> latest;
+};
+
+struct WorldFrame {
+    uint64_t frame = 0;
+    uint32_t tick = 0;
+    bool truncated = false;
+    int alive[KIND_COUNT] = {};
+    int dead[KIND_COUNT] = {};
+    std::vector<ShmEntity> entities;
+};
+
+class WorldPublisher {
+    std::string name;
+    uint64_t device, inode;
+    void* base;
+    size_t size;
+    ShmHeader* header;
+    uint64_t frame;
+
+    ShmFrameHeader* slot(uint64_t n) const;
+
+public:
+    WorldPublisher();
+    ~WorldPublisher();
+    WorldPublisher(const WorldPublisher&) = delete;
+    WorldPublisher& operator=(const WorldPublisher&) = delete;
+
+    bool open(const std::string& shm_name, uint32_t capacity, uint32_t slots = 8);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    void publish(uint32_t tick, const std::vector<std::shared_ptr<NPC>>& npcs,
+                 const int (&alive)[KIND_COUNT], const int (&dead)[KIND_COUNT]);
+};
+
+class WorldReader {
+    void* base;
+    size_t size;
+    const ShmHeader* header;
+
+    const ShmFrameHeader* slot(uint64_t n) const;
+
+public:
+    WorldReader();
+    ~WorldReader();
+    WorldReader(const WorldReader&) = delete;
+    WorldReader& operator=(const WorldReader&) = delete;
+
+    bool open(const std::string& shm_name);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+    bool publisherLive() const;
+
+    uint64_t latestFrame() const;
+    uint64_t oldestFrame() const;
+    bool read(uint64_t frame, WorldFrame& out) const;
+    bool readLatest(WorldFrame& out) const;
+};
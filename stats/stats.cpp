@@ -0,0 +1,150 @@
+#include "stats.h"
+#include <algorithm>
+
+WorldStats::WorldStats(int map_width, int map_height)
+    : width(std::max(1, map_width)), height(std::max(1, map_height)), heat{}
+{
+    for (auto& a : alive) a.store(0);
+    for (auto& d : dead) d.store(0);
+}
+
+int WorldStats::cellX(int x) const {
+    return std::clamp((x - 1) * HEAT_CELLS / width, 0, HEAT_CELLS - 1);
+}
+
+int WorldStats::cellY(int y) const {
+    return std::clamp((y - 1) * HEAT_CELLS / height, 0, HEAT_CELLS - 1);
+}
+
+void WorldStats::onSpawn(const NPC& npc) {
+    int power = npc.getAttack() + npc.getDefense();
+    int cx = cellX(npc.getX());
+    int cy = cellY(npc.getY());
+    
+    std::lock_guard lock(m);
+    auto [it, inserted] = records.try_emplace(npc.getId(), Record{npc.getName(), npc.getKind(), power, 0, cx, cy});
+    if (!inserted) return;
+    
+    strongest.insert({power, npc.getId()});
+    heat[static_cast<size_t>(npc.getKind())][cy][cx]++;
+    alive[static_cast<size_t>(npc.getKind())]++;
+}
+
+void WorldStats::onMove(const NPC& npc) {
+    int cx = cellX(npc.getX());
+    int cy = cellY(npc.getY());
+    
+    std::lock_guard lock(m);
+    auto it = records.find(npc.getId());
+    if (it == records.end()) return;
+    
+    Record& r = it->second;
+    if (r.cell_x == cx && r.cell_y == cy) return;
+    
+    auto& h = heat[static_cast<size_t>(r.kind)];
+    h[r.cell_y][r.cell_x]--;
+    h[cy][cx]++;
+    r.cell_x = cx;
+    r.cell_y = cy;
+}
+
+void WorldStats::retire(const NPC& npc) {
+    auto it = records.find(npc.getId());
+    if (it == records.end()) return;
+    
+    Record& r = it->second;
+    strongest.erase({r.power, npc.getId()});
+    if (r.kills > 0) lethal.erase({r.kills, npc.getId()});
+    heat[static_cast<size_t>(r.kind)][r.cell_y][r.cell_x]--;
+    alive[static_cast<size_t>(r.kind)]--;
+    dead[static_cast<size_t>(r.kind)]++;
+    records.erase(it);
+}
+
+void WorldStats::onKill(const NPC& killer, const NPC& victim) {
+    std::lock_guard lock(m);
+    retire(victim);
+    
+    auto it = records.find(killer.getId());
+    if (it == records.end()) return;
+    
+    Record& r = it->second;
+    if (r.kills > 0) lethal.erase({r.kills, killer.getId()});
+    r.kills++;
+    lethal.insert({r.kills, killer.getId()});
+}
+
+void WorldStats::onDeath(const NPC& npc) {
+    std::lock_guard lock(m);
+    retire(npc);
+}
+
+void WorldStats::onPowerUp(const NPC& npc) {
+    int power = npc.getAttack() + npc.getDefense();
+    
+    std::lock_guard lock(m);
+    auto it = records.find(npc.getId());
+    if (it == records.end()) return;
+    
+    Record& r = it->second;
+    strongest.erase({r.power, npc.getId()});
+    r.power = power;
+    strongest.insert({r.power, npc.getId()});
+}
+
+int WorldStats::totalAlive() const {
+    int total = 0;
+    for (const auto& a : alive) total += a.load(std::memory_order_relaxed);
+    return total;
+}
+
+int WorldStats::totalDead() const {
+    int total = 0;
+    for (const auto& d : dead) total += d.load(std::memory_order_relaxed);
+    return total;
+}
+
+int WorldStats::kills(uint64_t id) const {
+    std::lock_guard lock(m);
+    auto it = records.find(id);
+    return it == records.end() ? 0 : it->second.kills;
+}
+
+std::vector<LeaderboardEntry> WorldStats::top(const Board& board, size_t k) const {
+    std::vector<LeaderboardEntry> result;
+    result.reserve(std::min(k, board.size()));
+    
+    for (auto it = board.begin(); it != board.end() && result.size() < k; ++it) {
+        const Record& r = records.at(it->second);
+        result.push_back({it->second, r.name, r.kind, it->first});
+    }
+    return result;
+}
+
+std::vector<LeaderboardEntry> WorldStats::topStrongest(size_t k) const {
+    std::lock_guard lock(m);
+    return top(strongest, k);
+}
+
+std::vector<LeaderboardEntry> WorldStats::topLethal(size_t k) const {
+    std::lock_guard lock(m);
+    return top(lethal, k);
+}
+
+WorldStats::Heatmap WorldStats::heatmap(Kind k) const {
+    std::lock_guard lock(m);
+    return heat[static_cast<size_t>(k)];
+}
+
+WorldStats::Heatmap WorldStats::heatmap() const {
+    std::lock_guard lock(m);
+    Heatmap total{};
+    for (const auto& h : heat) {
+        for (int y = 0; y < HEAT_CELLS; ++y) {
+            for (int x = 0; x < HEAT_CELLS; ++x) {
+                total[y][x] += h[y][x];
+            }
+        }
+    }
+    return total;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <set>
+#include <unordered_map>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+#include "../npc.h"
+
+struct LeaderboardEntry {
+    uint64_t id;
+    std::string name;
+    Kind kind;
+    int value;
+};
+
+class WorldStats {
+public:
+    static constexpr int HEAT_CELLS = 10;
+    using Heatmap = std::array<std::array<int, HEAT_CELLS>, HEAT_CELLS>;
+
+private:
+    struct Record {
+        std::string name;
+        Kind kind;
+        int power;
+        int kills;
+        int cell_x, cell_y;
+    };
+    
+    using Board = std::set<std::pair<int, uint64_t>, std::greater<>>;
+    
+    int width, height;
+    
+    std::array<std::atomic<int>, KIND_COUNT> alive;
+    std::array<std::atomic<int>, KIND_COUNT> dead;
+    
+    std::unordered_map<uint64_t, Record> records;
+    Board strongest;
+    Board lethal;
+    std::array<Heatmap, KIND_COUNT> heat;
+    
+    mutable std::mutex m;
+    
+    int cellX(int x) const;
+    int cellY(int y) const;
+    std::vector<LeaderboardEntry> top(const Board& board, size_t k) const;
+    void retire(const NPC& npc);
+
+public:
+    WorldStats(int map_width, int map_height);
+    
+    void onSpawn(const NPC& npc);
+    void onMove(const NPC& npc);
+    void onKill(const NPC& killer, const NPC& victim);
+    void onDeath(const NPC& npc);
+    void onPowerUp(const NPC& npc);
+    
+    int aliveCount(Kind k) const { return alive[static_cast<size_t>(k)].load(std::memory_order_relaxed); }
+    int deadCount(Kind k) const { return dead[static_cast<size_t>(k)].load(std::memory_order_relaxed); }
+    int totalAlive() const;
+    int totalDead() const;
+    int kills(uint64_t id) const;
+    
+    std::vector<LeaderboardEntry> topStrongest(size_t k) const;
+    std::vector<LeaderboardEntry> topLethal(size_t k) const;
+    Heatmap heatmap(Kind k) const;
+    Heatmap heatmap() const;
+};
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "../journal/journal.h"
+
+namespace {
+
+void printState(const ReplayState& state, bool verbose) {
+    int counts[KIND_COUNT] = {};
+    for (const auto& [id, npc] : state.npcs) {
+        counts[static_cast<size_t>(npc.kind)]++;
+    }
+    
+    std::cout << "Тик " << state.tick << ": живые " << state.npcs.size()
+              << " (Медведи: " << counts[static_cast<size_t>(Kind::Bear)]
+              << " Эльфы: " << counts[static_cast<size_t>(Kind::Elf)]
+              << " Разбойники: " << counts[static_cast<size_t>(Kind::Robber)] << ")"
+              << ", боев " << state.fights << std::endl;
+    
+    if (!verbose) return;
+    
+    std::vector<std::pair<uint64_t, const ReplayNPC*>> sorted;
+    for (const auto& [id, npc] : state.npcs) sorted.emplace_back(id, &npc);
+    std::sort(sorted.begin(), sorted.end());
+    
+    for (const auto& [id, npc] : sorted) {
+        std::cout << "  " << npc->name << " (" << kindName(npc->kind) << ") "
+                  << "[" << npc->x << "," << npc->y << "] "
+                  << npc->attack << "/" << npc->defense << std::endl;
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Использование: " << argv[0] << " <журнал> [тик] [до_тика]" << std::endl;
+        return 1;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    JournalReader reader(argv[1]);
+    if (!reader.valid()) {
+        std::cerr << "Не удалось прочитать журнал: " << argv[1] << std::endl;
+        return 1;
+    }
+    auto loaded = std::chrono::steady_clock::now();
+    
+    std::cout << "Тиков: " << reader.lastTick() << ", ключевых кадров: " << reader.keyframeCount()
+              << ", загрузка " << std::chrono::duration<double, std::milli>(loaded - start).count()
+              << " мс" << std::endl;
+    
+    try {
+        uint32_t from = argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : reader.lastTick();
+        
+        if (argc > 3) {
+            uint32_t to = static_cast<uint32_t>(std::stoul(argv[3]));
+            reader.replay(from, to, [](const ReplayState& state) { printState(state, false); });
+        } else {
+            auto seek_start = std::chrono::steady_clock::now();
+            ReplayState state = reader.seek(from);
+            auto seek_end = std::chrono::steady_clock::now();
+            
+            printState(state, true);
+            std::cout << "Переход к тику: "
+                      << std::chrono::duration<double, std::milli>(seek_end - seek_start).count()
+                      << " мс" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
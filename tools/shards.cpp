@@ -0,0 +1,71 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include "../shard/shard.h"
+
+int main(int argc, char** argv) {
+    if (argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help")) {
+        std::cout << "Использование: " << argv[0] << " [шарды] [тики] [NPC] [ширина]\n"
+                  << "Автономный режим: шарды перемещают NPC и решают бои по собственным правилам\n"
+                  << "(FightRule без бросков кубиков), поэтому результаты не воспроизводят игру." << std::endl;
+        return 0;
+    }
+    
+    ShardConfig config;
+    config.shards = argc > 1 ? std::stoi(argv[1]) : 4;
+    uint32_t ticks = argc > 2 ? static_cast<uint32_t>(std::stoul(argv[2])) : 100;
+    size_t count = argc > 3 ? std::stoul(argv[3]) : 10000;
+    config.width = argc > 4 ? std::stoi(argv[4]) : 500;
+    config.height = config.width;
+    
+    try {
+        ShardCoordinator coordinator(config);
+        coordinator.start();
+        coordinator.spawn(count);
+        
+        std::cout << "Автономный режим шардов (результаты не воспроизводят игру)" << std::endl;
+        std::cout << "Шардов: " << config.shards << ", NPC: " << count
+                  << ", карта: " << config.width << "x" << config.height << std::endl;
+        
+        auto start = std::chrono::steady_clock::now();
+        ShardReport report;
+        uint64_t fights = 0, migrations = 0;
+        
+        for (uint32_t t = 0; t < ticks; ++t) {
+            report = coordinator.tick();
+            fights += report.fights;
+            migrations += report.migrations;
+            
+            if (report.tick % 10 == 0 || t + 1 == ticks) {
+                std::cout << "Тик " << report.tick
+                          << ": Медведи " << report.alive[static_cast<size_t>(Kind::Bear)]
+                          << " Эльфы " << report.alive[static_cast<size_t>(Kind::Elf)]
+                          << " Разбойники " << report.alive[static_cast<size_t>(Kind::Robber)]
+                          << " | боев " << report.fights << ", миграций " << report.migrations << std::endl;
+            }
+        }
+        
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        coordinator.stop();
+        
+        long alive = 0, dead = 0;
+        for (size_t k = 0; k < KIND_COUNT; ++k) {
+            alive += report.alive[k];
+            dead += report.dead[k];
+        }
+        
+        std::cout << "Итого: живые " << alive << ", погибшие " << dead
+                  << ", боев " << fights << ", миграций " << migrations << std::endl;
+        std::cout << "Скорость: " << (elapsed > 0 ? ticks / elapsed : 0) << " тиков/с" << std::endl;
+        
+        if (static_cast<size_t>(alive + dead) != count) {
+            std::cerr << "Ошибка: потеряны NPC (" << alive + dead << " из " << count << ")" << std::endl;
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
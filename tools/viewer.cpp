@@ -0,0 +1,51 @@
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include "../shm/shm.h"
+
+int main(int argc, char** argv) {
+    std::string name = argc > 1 ? argv[1] : "/oop_laba7_world";
+    uint64_t limit = argc > 2 ? std::stoull(argv[2]) : 0;
+    
+    WorldReader reader;
+    for (int attempt = 0; attempt < 50 && !reader.open(name); ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    if (!reader.isOpen()) {
+        std::cerr << "Не удалось открыть общую память: " << name << std::endl;
+        return 1;
+    }
+    
+    WorldFrame frame;
+    uint64_t last = 0, seen = 0, missed = 0;
+    
+    while (reader.publisherLive() && (limit == 0 || seen < limit)) {
+        uint64_t latest = reader.latestFrame();
+        if (latest == last) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        
+        uint64_t from = std::max(last + 1, reader.oldestFrame());
+        missed += from - (last + 1);
+        
+        for (uint64_t n = from; n <= latest; ++n) {
+            if (!reader.read(n, frame)) {
+                ++missed;
+                continue;
+            }
+            ++seen;
+            std::cout << "Кадр " << frame.frame << " тик " << frame.tick
+                      << ": NPC " << frame.entities.size() << (frame.truncated ? "+" : "")
+                      << " | Медведи " << frame.alive[static_cast<size_t>(Kind::Bear)]
+                      << " Эльфы " << frame.alive[static_cast<size_t>(Kind::Elf)]
+                      << " Разбойники " << frame.alive[static_cast<size_t>(Kind::Robber)]
+                      << " | Погибло " << frame.dead[0] + frame.dead[1] + frame.dead[2] << std::endl;
+        }
+        last = latest;
+    }
+    
+    std::cout << "Прочитано кадров: " << seen << ", пропущено: " << missed << std::endl;
+    return 0;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <array>
+#include <utility>
+#include <type_traits>
+#include "../npc.h"
+
+template <Kind K> struct KindTraits;
+template <> struct KindTraits<Kind::Bear> { using type = Bear; };
+template <> struct KindTraits<Kind::Elf> { using type = Elf; };
+template <> struct KindTraits<Kind::Robber> { using type = Robber; };
+
+namespace dispatch_detail {
+
+template <class N, size_t I>
+using Concrete = std::conditional_t<std::is_const_v<N>,
+                                    const typename KindTraits<static_cast<Kind>(I)>::type,
+                                    typename KindTraits<static_cast<Kind>(I)>::type>;
+
+template <class R, class N, class V, size_t I>
+R callOne(N& npc, V& v) {
+    return v(static_cast<Concrete<N, I>&>(npc));
+}
+
+template <class R, class N, class V, size_t I>
+R callTwo(N& a, N& b, V& v) {
+    return v(static_cast<Concrete<N, I / KIND_COUNT>&>(a),
+             static_cast<Concrete<N, I % KIND_COUNT>&>(b));
+}
+
+template <class R, class N, class V, size_t... I>
+constexpr auto oneTable(std::index_sequence<I...>) {
+    return std::array<R (*)(N&, V&), sizeof...(I)>{&callOne<R, N, V, I>...};
+}
+
+template <class R, class N, class V, size_t... I>
+constexpr auto twoTable(std::index_sequence<I...>) {
+    return std::array<R (*)(N&, N&, V&), sizeof...(I)>{&callTwo<R, N, V, I>...};
+}
+
+}
+
+template <class N, class V>
+    requires std::is_same_v<std::remove_const_t<N>, NPC>
+decltype(auto) dispatch(N& npc, V&& visitor) {
+    using Visitor = std::remove_reference_t<V>;
+    using R = decltype(visitor(std::declval<dispatch_detail::Concrete<N, 0>&>()));
+    static constexpr auto table =
+        dispatch_detail::oneTable<R, N, Visitor>(std::make_index_sequence<KIND_COUNT>{});
+    return table[static_cast<size_t>(npc.getKind())](npc, visitor);
+}
+
+template <class N, class V>
+    requires std::is_same_v<std::remove_const_t<N>, NPC>
+decltype(auto) dispatch(N& a, N& b, V&& visitor) {
+    using Visitor = std::remove_reference_t<V>;
+    using R = decltype(visitor(std::declval<dispatch_detail::Concrete<N, 0>&>(),
+                               std::declval<dispatch_detail::Concrete<N, 0>&>()));
+    static constexpr auto table =
+        dispatch_detail::twoTable<R, N, Visitor>(std::make_index_sequence<KIND_COUNT * KIND_COUNT>{});
+    return table[static_cast<size_t>(a.getKind()) * KIND_COUNT + static_cast<size_t>(b.getKind())](a, b, visitor);
+}
@@ -0,0 +1,141 @@
+#include "kernel.h"
+#include <array>
+#include <vector>
+#include "rules.h"
+
+#if defined(__SANITIZE_THREAD__)
+#define FIGHT_KERNEL_NO_CLONES
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define FIGHT_KERNEL_NO_CLONES
+#endif
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__linux__) && !defined(FIGHT_KERNEL_NO_CLONES)
+#define FIGHT_KERNEL_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define FIGHT_KERNEL_CLONES
+#endif
+
+namespace {
+
+struct RuleMasks {
+    std::array<int32_t, KIND_COUNT * KIND_COUNT> fixed;
+    std::array<int32_t, KIND_COUNT * KIND_COUNT> a_wins;
+    std::array<int32_t, KIND_COUNT * KIND_COUNT> b_wins;
+};
+
+constexpr RuleMasks makeRuleMasks() {
+    RuleMasks masks{};
+    for (size_t i = 0; i < KIND_COUNT * KIND_COUNT; ++i) {
+        auto strong = rules_detail::FIGHT_RULES[i](2, 1, 2, 1);
+        auto weak = rules_detail::FIGHT_RULES[i](0, 1, 0, 1);
+        bool fixed = strong == weak;
+        masks.fixed[i] = fixed ? -1 : 0;
+        masks.a_wins[i] = fixed && strong.first ? -1 : 0;
+        masks.b_wins[i] = fixed && strong.second ? -1 : 0;
+    }
+    return masks;
+}
+
+constexpr RuleMasks RULE_MASKS = makeRuleMasks();
+
+constexpr uint8_t kernelOutcome(int32_t fixed, int32_t a_rule, int32_t d_rule,
+                                int32_t a_attack, int32_t a_defense, int32_t d_attack, int32_t d_defense) {
+    int32_t a_hits = -static_cast<int32_t>(a_attack > d_defense);
+    int32_t d_hits = -static_cast<int32_t>(d_attack > a_defense);
+    int32_t a_wins = (a_rule & fixed) | (a_hits & ~fixed);
+    int32_t d_wins = (d_rule & fixed) | (d_hits & ~fixed);
+    
+    return static_cast<uint8_t>(
+        (~a_wins & ATTACKER_DIES) |
+        (~d_wins & DEFENDER_DIES) |
+        (a_wins & ~d_wins & ATTACKER_POWERS_UP) |
+        (d_wins & ~a_wins & DEFENDER_POWERS_UP));
+}
+
+constexpr bool kernelMatchesRules() {
+    constexpr int32_t STATS[] = {-1, 0, 1, 2, 3, 50};
+    for (size_t pair = 0; pair < KIND_COUNT * KIND_COUNT; ++pair) {
+        for (int32_t aa : STATS) for (int32_t ad : STATS) for (int32_t da : STATS) for (int32_t dd : STATS) {
+            auto [a_wins, d_wins] = rules_detail::FIGHT_RULES[pair](aa, ad, da, dd);
+            uint8_t o = kernelOutcome(RULE_MASKS.fixed[pair], RULE_MASKS.a_wins[pair], RULE_MASKS.b_wins[pair],
+                                      aa, ad, da, dd);
+            if (static_cast<bool>(o & ATTACKER_DIES) == a_wins) return false;
+            if (static_cast<bool>(o & DEFENDER_DIES) == d_wins) return false;
+        }
+    }
+    return true;
+}
+
+static_assert(kernelMatchesRules(), "FightRule не сводится к константе или к правилу атака > защита; ядро боя его не поддерживает");
+
+struct PairColumns {
+    std::vector<int32_t> a_attack, a_defense, d_attack, d_defense;
+    std::vector<int32_t> fixed, a_rule, d_rule;
+    
+    void resize(size_t n) {
+        for (auto* c : {&a_attack, &a_defense, &d_attack, &d_defense, &fixed, &a_rule, &d_rule}) c->resize(n);
+    }
+};
+
+thread_local PairColumns pair_columns;
+
+FIGHT_KERNEL_CLONES
+void resolveDense(const int32_t* __restrict fixed, const int32_t* __restrict a_rule, const int32_t* __restrict d_rule,
+                  const int32_t* __restrict a_attack, const int32_t* __restrict a_defense,
+                  const int32_t* __restrict d_attack, const int32_t* __restrict d_defense,
+                  size_t count, uint8_t* __restrict outcomes) {
+    for (size_t i = 0; i < count; ++i) {
+        outcomes[i] = kernelOutcome(fixed[i], a_rule[i], d_rule[i], a_attack[i], a_defense[i], d_attack[i], d_defense[i]);
+    }
+}
+
+inline uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+}
+
+void resolveFightBatch(const FightColumns& columns, const uint32_t* attackers, const uint32_t* defenders,
+                       size_t count, uint8_t* outcomes) {
+    PairColumns& p = pair_columns;
+    p.resize(count);
+    
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t a = attackers[i];
+        uint32_t d = defenders[i];
+        size_t pair = static_cast<size_t>(columns.kind[a]) * KIND_COUNT + static_cast<size_t>(columns.kind[d]);
+        p.a_attack[i] = columns.attack[a];
+        p.a_defense[i] = columns.defense[a];
+        p.d_attack[i] = columns.attack[d];
+        p.d_defense[i] = columns.defense[d];
+        p.fixed[i] = RULE_MASKS.fixed[pair];
+        p.a_rule[i] = RULE_MASKS.a_wins[pair];
+        p.d_rule[i] = RULE_MASKS.b_wins[pair];
+    }
+    
+    resolveDense(p.fixed.data(), p.a_rule.data(), p.d_rule.data(),
+                 p.a_attack.data(), p.a_defense.data(), p.d_attack.data(), p.d_defense.data(),
+                 count, outcomes);
+}
+
+FIGHT_KERNEL_CLONES
+void rollDiceBatch(uint64_t seed, uint64_t counter, size_t count, uint8_t* rolls) {
+    uint64_t base = mix(seed) + counter * 0x9E3779B97F4A7C15ULL;
+    
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t r = mix(base + i * 0x9E3779B97F4A7C15ULL);
+        rolls[i] = static_cast<uint8_t>(1 + (((r & 0xFFFFFFFFULL) * 6) >> 32));
+    }
+}
+
+FIGHT_KERNEL_CLONES
+void duelBatch(const uint8_t* attack_rolls, const uint8_t* defense_rolls, size_t count, uint8_t* outcomes) {
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t wins = static_cast<uint8_t>(-static_cast<int>(attack_rolls[i] > defense_rolls[i]));
+        outcomes[i] = static_cast<uint8_t>(wins & DEFENDER_DIES);
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "../npc.h"
+
+enum FightOutcomeBits : uint8_t {
+    ATTACKER_DIES = 1,
+    DEFENDER_DIES = 2,
+    ATTACKER_POWERS_UP = 4,
+    DEFENDER_POWERS_UP = 8
+};
+
+struct FightColumns {
+    const int32_t* attack;
+    const int32_t* defense;
+    const Kind* kind;
+};
+
+void resolveFightBatch(const FightColumns& columns, const uint32_t* attackers, const uint32_t* defenders,
+                       size_t count, uint8_t* outcomes);
+
+void rollDiceBatch(uint64_t seed, uint64_t counter, size_t count, uint8_t* rolls);
+
+void duelBatch(const uint8_t* attack_rolls, const uint8_t* defense_rolls, size_t count, uint8_t* outcomes);
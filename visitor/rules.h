@@ -0,0 +1,61 @@
+#pragma once
+#include <array>
+#include <utility>
+#include "dispatch.h"
+
+template <Kind A, Kind B>
+struct FightRule {
+    static constexpr std::pair<bool, bool> resolve(int a_attack, int a_defense, int b_attack, int b_defense) {
+        return {a_attack > b_defense, b_attack > a_defense};
+    }
+};
+
+template <> struct FightRule<Kind::Elf, Kind::Robber> {
+    static constexpr std::pair<bool, bool> resolve(int, int, int, int) { return {true, false}; }
+};
+
+template <> struct FightRule<Kind::Robber, Kind::Elf> {
+    static constexpr std::pair<bool, bool> resolve(int, int, int, int) { return {false, true}; }
+};
+
+template <> struct FightRule<Kind::Robber, Kind::Robber> {
+    static constexpr std::pair<bool, bool> resolve(int, int, int, int) { return {false, false}; }
+};
+
+template <> struct FightRule<Kind::Bear, Kind::Elf> {
+    static constexpr std::pair<bool, bool> resolve(int, int, int, int) { return {true, false}; }
+};
+
+template <> struct FightRule<Kind::Elf, Kind::Bear> {
+    static constexpr std::pair<bool, bool> resolve(int, int, int, int) { return {false, true}; }
+};
+
+struct FightResolver {
+    template <class A, class B>
+    std::pair<bool, bool> operator()(const A& a, const B& b) const {
+        return FightRule<A::KIND, B::KIND>::resolve(a.getAttack(), a.getDefense(), b.getAttack(), b.getDefense());
+    }
+};
+
+inline std::pair<bool, bool> resolveFight(const NPC& a, const NPC& b) {
+    return dispatch(a, b, FightResolver{});
+}
+
+
+namespace rules_detail {
+
+using RuleFn = std::pair<bool, bool> (*)(int, int, int, int);
+
+template <size_t... I>
+constexpr std::array<RuleFn, sizeof...(I)> ruleTable(std::index_sequence<I...>) {
+    return {&FightRule<static_cast<Kind>(I / KIND_COUNT), static_cast<Kind>(I % KIND_COUNT)>::resolve...};
+}
+
+inline constexpr auto FIGHT_RULES = ruleTable(std::make_index_sequence<KIND_COUNT * KIND_COUNT>{});
+
+}
+
+inline std::pair<bool, bool> resolveFight(Kind a, int a_attack, int a_defense, Kind b, int b_attack, int b_defense) {
+    return rules_detail::FIGHT_RULES[static_cast<size_t>(a) * KIND_COUNT + static_cast<size_t>(b)](
+        a_attack, a_defense, b_attack, b_defense);
+}
@@ -1,13 +1,17 @@
 #include "visitor.h"
+#include "rules.h"
+#include "kernel.h"
 #include <cmath>
 #include <algorithm>
-#include <iostream>
+#include <unordered_set>
 #include <thread>
 #include <chrono>
 
 FightVisitor::FightVisitor(std::vector<std::shared_ptr<NPC>>& n, double d)
-    : npcs(n), dist(d), stop_requested(false)
-{}
+    : npcs(n), dist(d), stop_requested(false), contacts(d), stats(nullptr)
+{
+    for (const auto& npc : npcs) contacts.add(npc);
+}
 
 FightVisitor::~FightVisitor() {
     stop();
@@ -17,9 +21,23 @@ void FightVisitor::addObserver(IObserver* o) {
     observers.push_back(o);
 }
 
-void FightVisitor::logMessage(const std::string& message) {
-    std::lock_guard<std::mutex> lock(cout_mutex);
-    std::cout << "[FIGHT] " << message << std::endl;
+void FightVisitor::setStats(WorldStats* s) {
+    stats = s;
+}
+
+void FightVisitor::npcAdded(const std::shared_ptr<NPC>& npc) {
+    std::lock_guard lock(contacts_mutex);
+    contacts.add(npc);
+}
+
+void FightVisitor::npcMoved(const std::shared_ptr<NPC>& npc) {
+    std::lock_guard lock(contacts_mutex);
+    contacts.markMoved(npc);
+}
+
+void FightVisitor::forgetContact(const std::shared_ptr<NPC>& npc) {
+    std::lock_guard lock(contacts_mutex);
+    contacts.remove(npc);
 }
 
 double FightVisitor::distance(NPC& a, NPC& b) {
@@ -27,55 +45,48 @@ double FightVisitor::distance(NPC& a, NPC& b) {
 }
 
 std::pair<bool,bool> FightVisitor::fight(NPC& A, NPC& B) {
-    std::string t1 = A.type();
-    std::string t2 = B.type();
-    
-    if (t1 == "Elf" && t2 == "Robber") return {true, false};   
-    if (t1 == "Robber" && t2 == "Elf") return {false, true};  
-    
-    if (t1 == "Robber" && t2 == "Robber") return {false, false}; 
-    
-    if (t1 == "Bear" && t2 == "Elf") return {true, false};  
-    if (t1 == "Elf" && t2 == "Bear") return {false, true};  
-    
-    if (A.getAttack() > B.getDefense() && B.getAttack() > A.getDefense()) {
-        return {true, true};  
-    } else if (A.getAttack() > B.getDefense()) {
-        return {true, false};  
-    } else if (B.getAttack() > A.getDefense()) {
-        return {false, true};  
-    } else {
-        return {false, false}; 
-    }
+    return resolveFight(A, B);
 }
 
 void FightVisitor::processSingleFight(std::shared_ptr<NPC> a, std::shared_ptr<NPC> b) {
     auto [aWin, bWin] = fight(*a, *b);
-    std::string Aname = a->getName();
-    std::string Bname = b->getName();
+    applyFight(a, b, aWin, bWin);
+}
+
+void FightVisitor::applyFight(const std::shared_ptr<NPC>& a, const std::shared_ptr<NPC>& b, bool aWin, bool bWin) {
+    const std::string& Aname = a->getName();
+    const std::string& Bname = b->getName();
     
-    logMessage("Бой между " + Aname + " [" + a->type() + "] и " + Bname + " [" + b->type() + "]");
+    logMessage(LogLevel::Info, "Бой между {} [{}] и {} [{}]", Aname, a->getKind(), Bname, b->getKind());
     
     if (aWin && !bWin) {
         a->increasePower();
+        if (stats) stats->onPowerUp(*a);
         for(auto o: observers) o->onKill(Aname, Bname);
         
         std::unique_lock lock(npcs_mutex);
         auto it = std::find(npcs.begin(), npcs.end(), b);
         if (it != npcs.end()) {
+            b->markDead();
+            if (stats) stats->onKill(*a, *b);
             npcs.erase(it);
-            logMessage(Aname + " убил " + Bname + " и стал сильнее!");
+            forgetContact(b);
+            logMessage(LogLevel::Info, "{} убил {} и стал сильнее!", Aname, Bname);
         }
     }
     else if (!aWin && bWin) {
         b->increasePower();
+        if (stats) stats->onPowerUp(*b);
         for(auto o: observers) o->onKill(Bname, Aname);
         
         std::unique_lock lock(npcs_mutex);
         auto it = std::find(npcs.begin(), npcs.end(), a);
         if (it != npcs.end()) {
+            a->markDead();
+            if (stats) stats->onKill(*b, *a);
             npcs.erase(it);
-            logMessage(Bname + " убил " + Aname + " и стал сильнее!");
+            forgetContact(a);
+            logMessage(LogLevel::Info, "{} убил {} и стал сильнее!", Bname, Aname);
         }
     }
     else if (!aWin && !bWin) {
@@ -86,6 +97,12 @@ void FightVisitor::processSingleFight(std::shared_ptr<NPC> a, std::shared_ptr<NP
         auto it_b = std::find(npcs.begin(), npcs.end(), b);
         
         if (it_a != npcs.end() && it_b != npcs.end()) {
+            a->markDead();
+            b->markDead();
+            if (stats) {
+                stats->onDeath(*a);
+                stats->onDeath(*b);
+            }
             if (std::distance(npcs.begin(), it_a) > std::distance(npcs.begin(), it_b)) {
                 npcs.erase(it_a);
                 npcs.erase(it_b);
@@ -93,73 +110,118 @@ void FightVisitor::processSingleFight(std::shared_ptr<NPC> a, std::shared_ptr<NP
                 npcs.erase(it_b);
                 npcs.erase(it_a);
             }
-            logMessage(Aname + " и " + Bname + " погибли вместе!");
+            forgetContact(a);
+            forgetContact(b);
+            logMessage(LogLevel::Info, "{} и {} погибли вместе!", Aname, Bname);
         }
     }
     else {
-        logMessage(Aname + " и " + Bname + " не смогли убить друг друга");
+        logMessage(LogLevel::Info, "{} и {} не смогли убить друг друга", Aname, Bname);
     }
 }
 
 void FightVisitor::detectFights() {
-    logMessage("Запущен поток обнаружения боев");
+    logMessage(LogLevel::Debug, "Запущен поток обнаружения боев");
     
     while (!stop_requested) {
-        std::vector<std::pair<std::shared_ptr<NPC>, std::shared_ptr<NPC>>> local_fights;
+        std::vector<std::pair<std::shared_ptr<NPC>, std::shared_ptr<NPC>>> local_fights, rejected;
         
         {
-            std::shared_lock lock(npcs_mutex);
-            
-            for (size_t i = 0; i < npcs.size(); ++i) {
-                for (size_t j = i + 1; j < npcs.size(); ++j) {
-                    if (distance(*npcs[i], *npcs[j]) <= dist) {
-                        local_fights.emplace_back(npcs[i], npcs[j]);
-                    }
-                }
-            }
+            std::lock_guard lock(contacts_mutex);
+            local_fights = contacts.update();
         }
         
         if (!local_fights.empty()) {
-            std::lock_guard lock(queue_mutex);
-            for (auto& fight : local_fights) {
-                fight_queue.push(fight);
+            size_t found = local_fights.size();
+            size_t queued = fight_queue.pushBatch(local_fights, &rejected);
+            if (!rejected.empty()) {
+                std::lock_guard lock(contacts_mutex);
+                for (const auto& [a, b] : rejected) contacts.forget(a, b);
+                rejected.clear();
             }
-            queue_cv.notify_one();
-            logMessage("Обнаружено " + std::to_string(local_fights.size()) + " потенциальных боев");
+            logMessage(LogLevel::Debug, "Обнаружено {} потенциальных боев, в очередь добавлено {}", found, queued);
         }
         
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
     
-    logMessage("Поток обнаружения боев остановлен");
+    logMessage(LogLevel::Debug, "Поток обнаружения боев остановлен");
 }
 
 void FightVisitor::processFights() {
-    logMessage("Запущен поток обработки боев");
+    logMessage(LogLevel::Debug, "Запущен поток обработки боев");
+    
+    std::vector<FightQueue::Fight> batch, round;
+    std::unordered_set<const NPC*> engaged;
+    std::vector<int32_t> attack, defense;
+    std::vector<Kind> kinds;
+    std::vector<uint32_t> attackers, defenders;
+    std::vector<uint8_t> moved, outcomes;
+    
+    auto resolveRound = [&]() {
+        size_t n = round.size();
+        if (n == 0) return;
+        
+        attack.resize(2 * n);
+        defense.resize(2 * n);
+        kinds.resize(2 * n);
+        attackers.resize(n);
+        defenders.resize(n);
+        outcomes.resize(n);
+        
+        for (size_t i = 0; i < n; ++i) {
+            const NPC* side[2] = {round[i].first.get(), round[i].second.get()};
+            for (size_t s = 0; s < 2; ++s) {
+                attack[2 * i + s] = side[s]->getAttack();
+                defense[2 * i + s] = side[s]->getDefense();
+                kinds[2 * i + s] = side[s]->getKind();
+            }
+            attackers[i] = static_cast<uint32_t>(2 * i);
+            defenders[i] = static_cast<uint32_t>(2 * i + 1);
+        }
+        
+        resolveFightBatch({attack.data(), defense.data(), kinds.data()},
+                          attackers.data(), defenders.data(), n, outcomes.data());
+        
+        for (size_t i = 0; i < n; ++i) {
+            applyFight(round[i].first, round[i].second,
+                       !(outcomes[i] & ATTACKER_DIES), !(outcomes[i] & DEFENDER_DIES));
+        }
+        round.clear();
+        engaged.clear();
+    };
     
     while (!stop_requested) {
-        std::pair<std::shared_ptr<NPC>, std::shared_ptr<NPC>> fight_pair;
+        if (fight_queue.popBatch(batch, FIGHT_BATCH, &moved) == 0) break;
         
+        size_t stale = 0;
         {
-            std::unique_lock lock(queue_mutex);
-            queue_cv.wait(lock, [this]() {
-                return !fight_queue.empty() || stop_requested;
-            });
-            
-            if (stop_requested) break;
-            
-            if (!fight_queue.empty()) {
-                fight_pair = fight_queue.front();
-                fight_queue.pop();
+            std::shared_lock lock(npcs_mutex);
+            for (size_t i = 0; i < batch.size(); ++i) {
+                if (moved[i] && distance(*batch[i].first, *batch[i].second) > dist) {
+                    batch[i].first.reset();
+                    ++stale;
+                }
             }
         }
         
-        if (fight_pair.first && fight_pair.second) {
-            processSingleFight(fight_pair.first, fight_pair.second);
+        for (auto& fight : batch) {
+            if (!fight.first) continue;
+            if (engaged.count(fight.first.get()) || engaged.count(fight.second.get())) resolveRound();
+            if (!fight.first->isAlive() || !fight.second->isAlive()) {
+                ++stale;
+                continue;
+            }
+            engaged.insert(fight.first.get());
+            engaged.insert(fight.second.get());
+            round.push_back(std::move(fight));
         }
+        resolveRound();
+        
+        if (stale) fight_queue.reportStale(stale);
     }
     
-    logMessage("Поток обработки боев остановлен");
+    logMessage(LogLevel::Debug, "Поток обработки боев остановлен");
 }
 
 void FightVisitor::run() {
@@ -195,9 +257,9 @@ void FightVisitor::runAsync() {
 
 void FightVisitor::stop() {
     stop_requested = true;
-    queue_cv.notify_all();
+    fight_queue.close();
 }
 
-void FightVisitor::visit(Bear& b) {}
-void FightVisitor::visit(Elf& e) {}
-void FightVisitor::visit(Robber& r) {}
\ No newline at end of file
+FightQueueStats FightVisitor::queueStats() const {
+    return fight_queue.stats();
+}
\ No newline at end of file
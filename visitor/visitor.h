@@ -3,45 +3,55 @@
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
-#include <condition_variable>
-#include <queue>
 #include <atomic>
 #include "../npc.h"
 #include "../observer/observer.h"
+#include "../collision/collision.h"
+#include "../fightqueue/fightqueue.h"
+#include "../stats/stats.h"
+#include "../log/log.h"
 
 class FightVisitor {
 private:
+    static constexpr size_t FIGHT_BATCH = 256;
+    
     std::vector<std::shared_ptr<NPC>>& npcs;
     std::vector<IObserver*> observers;
     double dist;
     
-    std::queue<std::pair<std::shared_ptr<NPC>, std::shared_ptr<NPC>>> fight_queue;
-    mutable std::mutex queue_mutex;
+    FightQueue fight_queue;
     mutable std::shared_mutex npcs_mutex;
-    mutable std::mutex cout_mutex;
-    std::condition_variable queue_cv;
     std::atomic<bool> stop_requested;
+    ContactTracker contacts;
+    std::mutex contacts_mutex;
+    WorldStats* stats;
     
 public:
     FightVisitor(std::vector<std::shared_ptr<NPC>>& n, double d);
     ~FightVisitor();
     
     void addObserver(IObserver* o);
+    void setStats(WorldStats* s);
+    void npcAdded(const std::shared_ptr<NPC>& npc);
+    void npcMoved(const std::shared_ptr<NPC>& npc);
     
     void detectFights();
     void processFights();
     
-    void visit(Bear& b);
-    void visit(Elf& e);
-    void visit(Robber& r);
-    
     void run();  
     void runAsync();  
     void stop();
+    FightQueueStats queueStats() const;
     
 private:
     std::pair<bool, bool> fight(NPC& a, NPC& b);
     static double distance(NPC& a, NPC& b);
     void processSingleFight(std::shared_ptr<NPC> a, std::shared_ptr<NPC> b);
-    void logMessage(const std::string& message);
+    void forgetContact(const std::shared_ptr<NPC>& npc);
+    void applyFight(const std::shared_ptr<NPC>& a, const std::shared_ptr<NPC>& b, bool aWin, bool bWin);
+    
+    template <class... A>
+    void logMessage(LogLevel level, LogFormat<std::type_identity_t<A>...> fmt, const A&... args) {
+        Logger::write(level, "[FIGHT] ", fmt, args...);
+    }
 };
\ No newline at end of file